@@ -0,0 +1,127 @@
+#!/usr/bin/env bash
+# Build and run the Dexed offline benchmarks on the development machine
+#
+# Compiles the plugin sources natively (same flags as build.sh) together
+# with the tools in src/bench, then runs one of them:
+#   ./scripts/bench.sh [plugin] [args]   render every patch in banks/*.syx
+#   ./scripts/bench.sh kernel [args]     FmOpKernel microbenchmark
+#   ./scripts/bench.sh golden [--write]  check (or regenerate) the golden corpus
+#   ./scripts/bench.sh blocksize [args]  plugin bench and golden drift for each
+#                                        control block size (DEXED_LG_N 4..7)
+# Extra arguments are passed to the tool, e.g.:
+#   ./scripts/bench.sh --bank SynprezFM_01 --csv
+#
+# Set CXX to use a different compiler (default: g++) and CXXFLAGS to add
+# flags (e.g. -march=native, or "-D__ARM_NEON -Isrc/bench/neon_emu" to
+# build the NEON backend on x86).
+set -e
+
+SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
+REPO_ROOT="$(dirname "$SCRIPT_DIR")"
+CXX="${CXX:-g++}"
+CXXFLAGS="${CXXFLAGS:-}"
+GOLDEN_FILE="src/bench/golden_reference.txt"
+
+cd "$REPO_ROOT"
+
+MODE="plugin"
+case "$1" in
+    plugin|kernel|golden|blocksize)
+        MODE="$1"
+        shift
+        ;;
+esac
+
+PLUGIN_SOURCES="
+    src/dsp/dx7_plugin.cpp
+    src/dsp/msfa/dx7note.cc
+    src/dsp/msfa/env.cc
+    src/dsp/msfa/exp2.cc
+    src/dsp/msfa/fm_core.cc
+    src/dsp/msfa/fm_op_kernel.cc
+    src/dsp/msfa/freqlut.cc
+    src/dsp/msfa/lfo.cc
+    src/dsp/msfa/pitchenv.cc
+    src/dsp/msfa/sin.cc
+    src/dsp/msfa/porta.cpp"
+
+mkdir -p build/native
+
+echo "=== Building Dexed $MODE tool ($CXX) ===" >&2
+case "$MODE" in
+    plugin)
+        $CXX -g -O3 -std=c++14 $CXXFLAGS \
+            src/bench/dexed_bench.cpp $PLUGIN_SOURCES \
+            -o build/native/dexed_bench \
+            -Isrc/dsp \
+            -lm
+        ;;
+    kernel)
+        $CXX -g -O3 -std=c++14 $CXXFLAGS \
+            src/bench/kernel_bench.cpp \
+            src/dsp/msfa/exp2.cc \
+            src/dsp/msfa/fm_op_kernel.cc \
+            src/dsp/msfa/sin.cc \
+            -o build/native/kernel_bench \
+            -Isrc/dsp \
+            -lm
+        ;;
+    golden)
+        $CXX -g -O3 -std=c++14 $CXXFLAGS \
+            src/bench/golden.cpp $PLUGIN_SOURCES \
+            -o build/native/dexed_golden \
+            -Isrc/dsp \
+            -lm
+        ;;
+    blocksize)
+        for LG in 4 5 6 7; do
+            $CXX -g -O3 -std=c++14 $CXXFLAGS -DDEXED_LG_N=$LG \
+                src/bench/dexed_bench.cpp $PLUGIN_SOURCES \
+                -o build/native/dexed_bench_lg$LG \
+                -Isrc/dsp \
+                -lm
+            $CXX -g -O3 -std=c++14 $CXXFLAGS -DDEXED_LG_N=$LG \
+                src/bench/golden.cpp $PLUGIN_SOURCES \
+                -o build/native/dexed_golden_lg$LG \
+                -Isrc/dsp \
+                -lm
+        done
+        ;;
+esac
+
+echo "=== Running $MODE ===" >&2
+case "$MODE" in
+    plugin)
+        ./build/native/dexed_bench --module-dir "$REPO_ROOT" "$@"
+        ;;
+    kernel)
+        ./build/native/kernel_bench "$@"
+        ;;
+    golden)
+        if [ "$1" = "--write" ]; then
+            shift
+            ./build/native/dexed_golden --module-dir "$REPO_ROOT" --write "$GOLDEN_FILE" "$@"
+        else
+            ./build/native/dexed_golden --module-dir "$REPO_ROOT" --check "$GOLDEN_FILE" "$@"
+        fi
+        ;;
+    blocksize)
+        # Control rate and step against render cost, and how far the output
+        # moves from the N=64 corpus (RMS drift over all patches)
+        printf "%5s %10s %9s %12s %10s %10s\n" \
+            "N" "ctrl Hz" "step ms" "ns/block" "drift avg" "drift max"
+        for LG in 4 5 6 7; do
+            BLOCK=$((1 << LG))
+            NS=$(./build/native/dexed_bench_lg$LG --module-dir "$REPO_ROOT" "$@" |
+                awk '/^mean/ { print $2 } /^held/ { print $4 }')
+            DRIFT=$(./build/native/dexed_golden_lg$LG --module-dir "$REPO_ROOT" \
+                --check "$GOLDEN_FILE" --tolerance 1000000000 |
+                awk '/^rms drift/ { gsub(/[%,]/, ""); print $4, $6 }')
+            [ -z "$DRIFT" ] && DRIFT="0 0"
+            awk -v n=$BLOCK -v ns="$NS" -v drift="$DRIFT" 'BEGIN {
+                split(drift, d, " ")
+                printf "%5d %10.0f %9.3f %12s %9.3f%% %9.3f%%\n", n, 44100 / n, n * 1000 / 44100, ns, d[1], d[2]
+            }'
+        done
+        ;;
+esac
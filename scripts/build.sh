@@ -8,6 +8,8 @@ set -e
 SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
 REPO_ROOT="$(dirname "$SCRIPT_DIR")"
 IMAGE_NAME="move-anything-builder"
+# Extra compiler flags, e.g. CXXFLAGS=-DDEXED_LG_N=7 for 128-sample control blocks
+CXXFLAGS="${CXXFLAGS:-}"
 
 # Check if we need Docker
 if [ -z "$CROSS_PREFIX" ] && [ ! -f "/.dockerenv" ]; then
@@ -26,6 +28,7 @@ if [ -z "$CROSS_PREFIX" ] && [ ! -f "/.dockerenv" ]; then
     docker run --rm \
         -v "$REPO_ROOT:/build" \
         -u "$(id -u):$(id -g)" \
+        -e CXXFLAGS="$CXXFLAGS" \
         -w /build \
         "$IMAGE_NAME" \
         ./scripts/build.sh
@@ -49,7 +52,7 @@ mkdir -p dist/dexed
 
 # Compile DSP plugin
 echo "Compiling DSP plugin..."
-${CROSS_PREFIX}g++ -g -O3 -shared -fPIC -std=c++14 \
+${CROSS_PREFIX}g++ -g -O3 -shared -fPIC -std=c++14 $CXXFLAGS \
     src/dsp/dx7_plugin.cpp \
     src/dsp/msfa/dx7note.cc \
     src/dsp/msfa/env.cc \
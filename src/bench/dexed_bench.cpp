@@ -0,0 +1,514 @@
+/*
+ * Dexed offline benchmark host
+ *
+ * Drives the plugin exactly like the Move host does: move_plugin_init_v2,
+ * create_instance, on_midi and render_block in 128-frame blocks, but with
+ * no audio device attached. Renders a scripted phrase for every patch in
+ * every bank under <module_dir>/banks and reports the render cost.
+ *
+ * --stress instead renders a worst-case scenario (see run_stress) and
+ * reports the slowest block rather than the average.
+ *
+ * Built natively by scripts/bench.sh so numbers can be gathered on a
+ * development machine before a release goes to the device.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "plugin_api.h"
+
+/* Largest --frames value */
+#define MAX_HOST_FRAMES 1024
+
+/* Block budget at 44.1 kHz: frames / 44100 s */
+#define BLOCK_BUDGET_NS (1e9 * g_frames / MOVE_SAMPLE_RATE)
+
+/* Bench options */
+typedef struct {
+    const char *module_dir;
+    const char *bank_filter;   /* Only banks whose name contains this */
+    int hold_blocks;           /* Blocks with the chord held */
+    int tail_blocks;           /* Blocks after note-off */
+    int csv;
+    int perf;                  /* Enable and print the plugin's perf_stats */
+    int stress;                /* Run the worst-case scenario instead */
+    const char *trace_path;    /* Record the plugin's event trace and dump it here */
+    int fast_start;            /* Create the instance with "fast_start":1 */
+    int no_batch;              /* Turn voice_batch off */
+    const char *engine;        /* Value for the engine param, NULL = default */
+    const char *retire_floor;  /* Value for the retire_floor param, NULL = default */
+    const char *pure_kernel;   /* Value for the pure_kernel param, NULL = default */
+    int verbose;
+} bench_opts_t;
+
+/* Accumulated result for one patch */
+typedef struct {
+    double total_ns;
+    double max_ns;
+    int blocks;
+    int max_voices;
+    double voice_sum;
+} patch_result_t;
+
+static int g_verbose = 0;
+static int g_frames = MOVE_FRAMES_PER_BLOCK;   /* Host block size */
+
+/* --timed: MIDI for the next block, passed to dx7_render_block_events */
+#define MAX_BLOCK_EVENTS 16
+static int g_timed = 0;
+static dx7_midi_event_t g_events[MAX_BLOCK_EVENTS];
+static uint8_t g_event_msgs[MAX_BLOCK_EVENTS][3];
+static int g_event_count = 0;
+
+/* --float: render through dx7_render_block_float into these */
+static int g_float = 0;
+static float g_out_l[MAX_HOST_FRAMES];
+static float g_out_r[MAX_HOST_FRAMES];
+
+static void host_log(const char *msg) {
+    if (g_verbose) fprintf(stderr, "%s\n", msg);
+}
+
+static inline uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static int get_int_param(plugin_api_v2_t *api, void *inst, const char *key, int def) {
+    char buf[64];
+    if (api->get_param(inst, key, buf, sizeof(buf)) <= 0) return def;
+    return atoi(buf);
+}
+
+static void send_midi(plugin_api_v2_t *api, void *inst, uint8_t s, uint8_t d1, uint8_t d2) {
+    uint8_t msg[3] = { s, d1, d2 };
+    api->on_midi(inst, msg, 3, MOVE_MIDI_SOURCE_EXTERNAL);
+}
+
+/* Send now, or with --timed queue for the next block at frame offset */
+static void queue_midi(plugin_api_v2_t *api, void *inst, int offset,
+                       uint8_t s, uint8_t d1, uint8_t d2) {
+    if (!g_timed) {
+        send_midi(api, inst, s, d1, d2);
+        return;
+    }
+    if (g_event_count == MAX_BLOCK_EVENTS) return;
+    if (offset >= g_frames) offset = g_frames - 1;
+
+    /* Keep the list sorted by offset, same-offset events in arrival order */
+    int i = g_event_count++;
+    while (i > 0 && g_events[i - 1].offset > offset) {
+        g_events[i] = g_events[i - 1];
+        i--;
+    }
+    uint8_t *msg = g_event_msgs[g_event_count - 1];
+    msg[0] = s;
+    msg[1] = d1;
+    msg[2] = d2;
+    g_events[i].offset = offset;
+    g_events[i].source = MOVE_MIDI_SOURCE_EXTERNAL;
+    g_events[i].msg = msg;
+    g_events[i].len = 3;
+}
+
+/* Slowest block of a stress phase */
+typedef struct {
+    double worst_ns;
+    int worst_block;
+    double total_ns;
+    int blocks;
+    int steals;
+} stress_result_t;
+
+/* Render one block and fold its cost into the result */
+static void timed_block(plugin_api_v2_t *api, void *inst, int16_t *out, patch_result_t *r) {
+    uint64_t t0 = now_ns();
+    if (g_float) {
+        dx7_render_block_float(inst, g_out_l, g_out_r, g_frames, g_events, g_event_count);
+        g_event_count = 0;
+    } else if (g_timed) {
+        dx7_render_block_events(inst, out, g_frames, g_events, g_event_count);
+        g_event_count = 0;
+    } else {
+        api->render_block(inst, out, g_frames);
+    }
+    double dt = (double)(now_ns() - t0);
+
+    r->total_ns += dt;
+    if (dt > r->max_ns) r->max_ns = dt;
+    r->blocks++;
+
+    int voices = get_int_param(api, inst, "active_voices", 0);
+    r->voice_sum += voices;
+    if (voices > r->max_voices) r->max_voices = voices;
+}
+
+/* Scripted phrase: four-note chord with mod wheel sweep, then release tail.
+ * With --timed the chord is strummed across the first block. */
+static void run_patch(plugin_api_v2_t *api, void *inst, const bench_opts_t *o, patch_result_t *r) {
+    static const uint8_t chord[] = { 48, 55, 60, 64 };
+    int16_t out[MAX_HOST_FRAMES * 2];
+
+    memset(r, 0, sizeof(*r));
+    g_event_count = 0;
+    api->set_param(inst, "all_notes_off", "1");
+
+    for (unsigned i = 0; i < sizeof(chord); i++) {
+        queue_midi(api, inst, i * g_frames / sizeof(chord), 0x90, chord[i], 100);
+    }
+    for (int b = 0; b < o->hold_blocks; b++) {
+        if ((b & 15) == 0) {
+            queue_midi(api, inst, 0, 0xB0, 1, (uint8_t)((b * 127) / o->hold_blocks));
+        }
+        timed_block(api, inst, out, r);
+    }
+    for (unsigned i = 0; i < sizeof(chord); i++) {
+        queue_midi(api, inst, i * g_frames / sizeof(chord), 0x80, chord[i], 0);
+    }
+    queue_midi(api, inst, 0, 0xB0, 1, 0);
+    for (int b = 0; b < o->tail_blocks; b++) {
+        timed_block(api, inst, out, r);
+    }
+}
+
+/* Render one block, remember it if it is the slowest so far */
+static void stress_block(plugin_api_v2_t *api, void *inst, int16_t *out, stress_result_t *r) {
+    uint64_t t0 = now_ns();
+    api->render_block(inst, out, g_frames);
+    double dt = (double)(now_ns() - t0);
+
+    r->total_ns += dt;
+    if (dt > r->worst_ns) {
+        r->worst_ns = dt;
+        r->worst_block = r->blocks;
+    }
+    r->blocks++;
+}
+
+static void print_stress(const bench_opts_t *o, const char *phase, const stress_result_t *r) {
+    if (r->blocks == 0) return;
+    double avg = r->total_ns / r->blocks;
+    if (o->csv) {
+        printf("%s,%d,%d,%.0f,%.0f,%d,%.5f\n", phase, r->blocks, r->steals,
+               avg, r->worst_ns, r->worst_block, r->worst_ns / BLOCK_BUDGET_NS);
+    } else {
+        printf("%-8s %6d %7d %10.0f %10.0f %6d %8.5f\n", phase, r->blocks, r->steals,
+               avg, r->worst_ns, r->worst_block, r->worst_ns / BLOCK_BUDGET_NS);
+    }
+}
+
+/*
+ * Worst case: algorithm 32 (six carriers straight to the output), feedback 7
+ * and every operator at level 99 with its envelope held at full level, so
+ * no operator ever drops under the render threshold. Two phases:
+ *   held   every voice sounding, notes released under the sustain pedal
+ *   steal  pedal still down, one note-on per block, so each allocation
+ *          has to steal the oldest voice
+ */
+static void run_stress(plugin_api_v2_t *api, void *inst, const bench_opts_t *o) {
+    int16_t out[MAX_HOST_FRAMES * 2];
+    char key[32];
+    int voices = get_int_param(api, inst, "polyphony", 16);
+
+    api->set_param(inst, "all_notes_off", "1");
+    api->set_param(inst, "algorithm", "32");
+    api->set_param(inst, "feedback", "7");
+    for (int op = 1; op <= 6; op++) {
+        snprintf(key, sizeof(key), "op%d_level", op);
+        api->set_param(inst, key, "99");
+        snprintf(key, sizeof(key), "op%d_eg_r1", op);
+        api->set_param(inst, key, "99");
+        snprintf(key, sizeof(key), "op%d_eg_l1", op);
+        api->set_param(inst, key, "99");
+        snprintf(key, sizeof(key), "op%d_eg_l2", op);
+        api->set_param(inst, key, "99");
+        snprintf(key, sizeof(key), "op%d_eg_l3", op);
+        api->set_param(inst, key, "99");
+    }
+    api->set_param(inst, "render_time", "reset");
+
+    if (o->csv) {
+        printf("phase,blocks,steals,ns_per_block,worst_ns,worst_block,worst_rtf\n");
+    } else {
+        printf("stress: %d voices, algorithm 32, feedback 7, op levels 99\n", voices);
+        printf("%-8s %6s %7s %10s %10s %6s %8s\n",
+               "phase", "blocks", "steals", "ns/block", "worst ns", "at", "rtf");
+    }
+
+    /* Dense chord spread over the keyboard, held by the pedal */
+    stress_result_t held;
+    memset(&held, 0, sizeof(held));
+    send_midi(api, inst, 0xB0, 64, 127);
+    for (int v = 0; v < voices; v++) {
+        send_midi(api, inst, 0x90, (uint8_t)(36 + v * 3), 127);
+    }
+    for (int v = 0; v < voices; v++) {
+        send_midi(api, inst, 0x80, (uint8_t)(36 + v * 3), 0);
+    }
+    for (int b = 0; b < o->hold_blocks; b++) {
+        stress_block(api, inst, out, &held);
+    }
+    print_stress(o, "held", &held);
+
+    /* Steal storm: every note-on lands on a fully busy voice pool */
+    stress_result_t steal;
+    memset(&steal, 0, sizeof(steal));
+    for (int b = 0; b < o->hold_blocks; b++) {
+        uint8_t note = (uint8_t)(30 + (b * 7) % 64);
+        send_midi(api, inst, 0x90, note, 127);
+        send_midi(api, inst, 0x80, note, 0);
+        steal.steals++;
+        stress_block(api, inst, out, &steal);
+    }
+    print_stress(o, "steal", &steal);
+
+    if (o->perf && !o->csv) {
+        char stats[4096];
+        if (api->get_param(inst, "voice_stats", stats, sizeof(stats)) > 0) {
+            printf("voice_stats %s\n", stats);
+        }
+    }
+
+    send_midi(api, inst, 0xB0, 64, 0);
+    api->set_param(inst, "all_notes_off", "1");
+
+    if (!o->csv) {
+        char stats[512];
+        if (api->get_param(inst, "render_time", stats, sizeof(stats)) > 0) {
+            printf("render_time %s\n", stats);
+        }
+    }
+}
+
+static void usage(const char *argv0) {
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "  --module-dir DIR   directory containing banks/ (default: .)\n"
+        "  --bank NAME        only banks whose file name contains NAME\n"
+        "  --hold N           blocks with chord held (default: 344, ~1 s)\n"
+        "  --tail N           blocks after note-off (default: 172, ~0.5 s)\n"
+        "  --csv              machine-readable output\n"
+        "  --perf             enable per-stage timing and print perf_stats\n"
+        "  --stress           worst-case polyphony scenario, reports slowest block\n"
+        "  --trace FILE       record the plugin event trace and dump it to FILE\n"
+        "  --fast-start       create the instance in fast-start mode\n"
+        "  --no-batch         render feedback operators voice by voice\n"
+        "  --engine q24|float render engine (default: q24)\n"
+        "  --retire-floor DB  retire release tails below DB dBFS, 0 = never\n"
+        "  --pure KERNEL      compute_pure kernel: sine, resonator or diff\n"
+        "  --frames F         host block size, 1 to %d (default: %d); --hold\n"
+        "                     and --tail count blocks of this size\n"
+        "  --timed            pass MIDI with frame offsets (dx7_render_block_events)\n"
+        "                     and strum the chord across the first block\n"
+        "  --float            render float32 L/R (dx7_render_block_float)\n"
+        "  -v                 show plugin log messages\n",
+        argv0, MAX_HOST_FRAMES, MOVE_FRAMES_PER_BLOCK);
+}
+
+int main(int argc, char **argv) {
+    bench_opts_t o;
+    o.module_dir = ".";
+    o.bank_filter = NULL;
+    o.hold_blocks = 344;
+    o.tail_blocks = 172;
+    o.csv = 0;
+    o.perf = 0;
+    o.stress = 0;
+    o.trace_path = NULL;
+    o.fast_start = 0;
+    o.no_batch = 0;
+    o.engine = NULL;
+    o.retire_floor = NULL;
+    o.pure_kernel = NULL;
+    o.verbose = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--module-dir") == 0 && i + 1 < argc) {
+            o.module_dir = argv[++i];
+        } else if (strcmp(argv[i], "--bank") == 0 && i + 1 < argc) {
+            o.bank_filter = argv[++i];
+        } else if (strcmp(argv[i], "--hold") == 0 && i + 1 < argc) {
+            o.hold_blocks = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--tail") == 0 && i + 1 < argc) {
+            o.tail_blocks = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--csv") == 0) {
+            o.csv = 1;
+        } else if (strcmp(argv[i], "--perf") == 0) {
+            o.perf = 1;
+        } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            o.trace_path = argv[++i];
+        } else if (strcmp(argv[i], "--no-batch") == 0) {
+            o.no_batch = 1;
+        } else if (strcmp(argv[i], "--engine") == 0 && i + 1 < argc) {
+            o.engine = argv[++i];
+        } else if (strcmp(argv[i], "--retire-floor") == 0 && i + 1 < argc) {
+            o.retire_floor = argv[++i];
+        } else if (strcmp(argv[i], "--pure") == 0 && i + 1 < argc) {
+            o.pure_kernel = argv[++i];
+        } else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            g_frames = atoi(argv[++i]);
+            if (g_frames < 1) g_frames = 1;
+            if (g_frames > MAX_HOST_FRAMES) g_frames = MAX_HOST_FRAMES;
+        } else if (strcmp(argv[i], "--float") == 0) {
+            g_float = 1;
+        } else if (strcmp(argv[i], "--timed") == 0) {
+            g_timed = 1;
+        } else if (strcmp(argv[i], "--fast-start") == 0) {
+            o.fast_start = 1;
+        } else if (strcmp(argv[i], "--stress") == 0) {
+            o.stress = 1;
+        } else if (strcmp(argv[i], "-v") == 0) {
+            o.verbose = 1;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    g_verbose = o.verbose;
+
+    host_api_v1_t host;
+    memset(&host, 0, sizeof(host));
+    host.api_version = MOVE_PLUGIN_API_VERSION;
+    host.sample_rate = MOVE_SAMPLE_RATE;
+    host.frames_per_block = g_frames;
+    host.log = host_log;
+
+    plugin_api_v2_t *api = move_plugin_init_v2(&host);
+    if (!api || api->api_version != MOVE_PLUGIN_API_VERSION_2) {
+        fprintf(stderr, "Plugin did not return a v2 API\n");
+        return 1;
+    }
+
+    uint64_t create_t0 = now_ns();
+    void *inst = api->create_instance(o.module_dir, o.fast_start ? "{\"fast_start\":1}" : NULL);
+    double create_ns = (double)(now_ns() - create_t0);
+    if (!inst) {
+        fprintf(stderr, "create_instance failed\n");
+        return 1;
+    }
+    if (!o.csv) {
+        char stats[256];
+        if (api->get_param(inst, "create_time", stats, sizeof(stats)) > 0) {
+            printf("create_instance %.0f ns %s\n", create_ns, stats);
+        }
+    }
+
+    int bank_count = get_int_param(api, inst, "syx_bank_count", 0);
+    if (bank_count <= 0) {
+        fprintf(stderr, "No banks found in %s/banks\n", o.module_dir);
+        api->destroy_instance(inst);
+        return 1;
+    }
+
+    if (o.perf) api->set_param(inst, "perf_stats", "1");
+    if (o.trace_path) api->set_param(inst, "trace", "1");
+    if (o.no_batch) api->set_param(inst, "voice_batch", "0");
+    if (o.engine) api->set_param(inst, "engine", o.engine);
+    if (o.retire_floor) api->set_param(inst, "retire_floor", o.retire_floor);
+    if (o.pure_kernel) api->set_param(inst, "pure_kernel", o.pure_kernel);
+
+    if (o.stress) {
+        run_stress(api, inst, &o);
+        if (o.trace_path) api->set_param(inst, "trace_dump", o.trace_path);
+        if (o.perf) {
+            char stats[1024];
+            if (api->get_param(inst, "perf_stats", stats, sizeof(stats)) > 0) {
+                printf("perf_stats %s\n", stats);
+            }
+        }
+        api->destroy_instance(inst);
+        return 0;
+    }
+
+    if (o.csv) {
+        printf("bank,preset,name,ns_per_block,max_ns,rtf,avg_voices,max_voices\n");
+    } else {
+        printf("%-20s %3s  %-10s %10s %10s %8s %6s %4s\n",
+               "bank", "#", "name", "ns/block", "max ns", "rtf", "voices", "max");
+    }
+
+    double all_ns = 0;
+    int all_blocks = 0;
+    int patches = 0;
+    double worst_avg = 0;
+    char worst_name[192] = "";
+
+    for (int b = 0; b < bank_count; b++) {
+        char idx[16];
+        snprintf(idx, sizeof(idx), "%d", b);
+        api->set_param(inst, "syx_bank_index", idx);
+
+        char bank[128] = "";
+        api->get_param(inst, "syx_bank_name", bank, sizeof(bank));
+        if (o.bank_filter && !strstr(bank, o.bank_filter)) continue;
+
+        int count = get_int_param(api, inst, "preset_count", 0);
+        for (int p = 0; p < count; p++) {
+            snprintf(idx, sizeof(idx), "%d", p);
+            api->set_param(inst, "preset", idx);
+
+            char name[64] = "";
+            api->get_param(inst, "preset_name", name, sizeof(name));
+
+            patch_result_t r;
+            run_patch(api, inst, &o, &r);
+            if (r.blocks == 0) continue;
+
+            double avg = r.total_ns / r.blocks;
+            double rtf = avg / BLOCK_BUDGET_NS;
+            double voices = r.voice_sum / r.blocks;
+
+            if (o.csv) {
+                printf("%s,%d,\"%s\",%.0f,%.0f,%.5f,%.2f,%d\n",
+                       bank, p, name, avg, r.max_ns, rtf, voices, r.max_voices);
+            } else {
+                printf("%-20s %3d  %-10s %10.0f %10.0f %8.5f %6.2f %4d\n",
+                       bank, p, name, avg, r.max_ns, rtf, voices, r.max_voices);
+            }
+
+            all_ns += r.total_ns;
+            all_blocks += r.blocks;
+            patches++;
+            if (avg > worst_avg) {
+                worst_avg = avg;
+                snprintf(worst_name, sizeof(worst_name), "%s #%d %s", bank, p, name);
+            }
+        }
+    }
+
+    if (!o.csv && all_blocks > 0) {
+        double avg = all_ns / all_blocks;
+        printf("\n%d patches, %d blocks\n", patches, all_blocks);
+        printf("mean %.0f ns/block, rtf %.5f (budget %.0f ns)\n",
+               avg, avg / BLOCK_BUDGET_NS, BLOCK_BUDGET_NS);
+        printf("worst patch %.0f ns/block: %s\n", worst_avg, worst_name);
+
+        char stats[128];
+        if (api->get_param(inst, "retire_stats", stats, sizeof(stats)) > 0) {
+            printf("retire_stats %s\n", stats);
+        }
+        if (api->get_param(inst, "midi_latency", stats, sizeof(stats)) > 0) {
+            printf("midi_latency %s\n", stats);
+        }
+    }
+
+    if (o.perf) {
+        char stats[1024];
+        if (api->get_param(inst, "perf_stats", stats, sizeof(stats)) > 0) {
+            printf("perf_stats %s\n", stats);
+        }
+        if (api->get_param(inst, "render_time", stats, sizeof(stats)) > 0) {
+            printf("render_time %s\n", stats);
+        }
+    }
+
+    if (o.trace_path) api->set_param(inst, "trace_dump", o.trace_path);
+
+    api->destroy_instance(inst);
+    return 0;
+}
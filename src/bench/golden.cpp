@@ -0,0 +1,488 @@
+/*
+ * Dexed golden-output regression corpus
+ *
+ * Renders every patch of every bank under <module_dir>/banks with a fixed
+ * note/velocity/mod wheel script and records, per patch:
+ *   - a hash of the engine output (Dx7Note::compute / FmCore::render,
+ *     int32 mix before any output scaling),
+ *   - a hash of the plugin output (render_block, int16 interleaved),
+ *   - the RMS of the engine output and a few engine samples as excerpts.
+ *
+ * --write stores the corpus, --check compares against it. A hash match
+ * proves bit-exactness; on mismatch the excerpts and RMS show how far
+ * an optimized path has moved, and --tolerance accepts small drift.
+ *
+ * Built natively by scripts/bench.sh (./scripts/bench.sh golden).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <memory>
+
+#include "plugin_api.h"
+
+#include "msfa/synth.h"
+#include "msfa/fm_core.h"
+#include "msfa/fm_op_kernel.h"
+#include "msfa/dx7note.h"
+#include "msfa/lfo.h"
+#include "msfa/env.h"
+#include "msfa/exp2.h"
+#include "msfa/sin.h"
+#include "msfa/freqlut.h"
+#include "msfa/pitchenv.h"
+#include "msfa/porta.h"
+#include "msfa/tuning.h"
+#include "dx7_patch.h"
+
+#define PATCHES_PER_BANK 32
+#define SCRIPT_BLOCKS 72            /* 128-frame host blocks per patch */
+#define SCRIPT_SAMPLES (SCRIPT_BLOCKS * MOVE_FRAMES_PER_BLOCK)
+#define EXCERPT_LEN 4
+#define GOLDEN_VOICES 2
+#define MAX_HOST_FRAMES 1024
+
+/* Excerpt positions: held chord with full mod wheel, and release tail */
+static const int excerpt_pos[2] = { 5120, 7168 };
+
+/* Scripted events, applied at the start of a 128-frame block */
+typedef struct {
+    int block;
+    uint8_t status;
+    uint8_t data1;
+    uint8_t data2;
+} script_event_t;
+
+static const script_event_t g_script[] = {
+    { 0,  0x90, 60, 100 },
+    { 0,  0x90, 67, 64 },
+    { 16, 0xB0, 1, 64 },
+    { 32, 0xB0, 1, 127 },
+    { 48, 0x80, 60, 0 },
+    { 48, 0x80, 67, 0 },
+};
+#define SCRIPT_EVENTS ((int)(sizeof(g_script) / sizeof(g_script[0])))
+
+/* --engine float: render through FloatFmCore / the plugin's float engine */
+static bool g_float_engine = false;
+/* --sine: operator sine source, table unless asked (whatever the build default) */
+static bool g_sine_poly = false;
+/* --pure: compute_pure kernel */
+static FmOpKernel::PureKernel g_pure = FmOpKernel::PURE_SINE;
+/* --frames: host block size handed to render_block */
+static int g_frames = MOVE_FRAMES_PER_BLOCK;
+/* --timed: deliver the script through dx7_render_block_events */
+static bool g_timed = false;
+
+/* One corpus line */
+typedef struct {
+    char bank[128];
+    int preset;
+    uint32_t engine_hash;
+    uint32_t plugin_hash;
+    uint32_t rms;
+    int32_t excerpt[2 * EXCERPT_LEN];
+} golden_entry_t;
+
+static void host_log(const char *msg) {
+    (void)msg;
+}
+
+/* FNV-1a over the little-endian bytes of each value */
+static inline uint32_t fnv_add(uint32_t h, uint32_t v) {
+    for (int i = 0; i < 4; i++) {
+        h ^= (v >> (i * 8)) & 0xff;
+        h *= 16777619u;
+    }
+    return h;
+}
+#define FNV_INIT 2166136261u
+
+/* Load the 32 unpacked patches of a bank, returns 0 on success */
+static int load_bank(const char *path, uint8_t patches[PATCHES_PER_BANK][156]) {
+    FILE *f = fopen(path, "rb");
+    if (!f) return -1;
+    uint8_t data[4104];
+    size_t n = fread(data, 1, sizeof(data), f);
+    fclose(f);
+    if (n != sizeof(data) || data[0] != 0xF0 || data[1] != 0x43 || data[3] != 0x09) {
+        return -1;
+    }
+    for (int i = 0; i < PATCHES_PER_BANK; i++) {
+        unpack_patch(&data[6 + i * 128], patches[i]);
+    }
+    return 0;
+}
+
+/* Controller setup matching v2_create_instance */
+static void setup_controllers(Controllers *c, FmCore *core) {
+    c->core = core;
+    c->masterTune = 0;
+    memset(c->values_, 0, sizeof(c->values_));
+    c->values_[kControllerPitch] = 0x2000;
+    c->values_[kControllerPitchRangeUp] = 2;
+    c->values_[kControllerPitchRangeDn] = 2;
+    c->values_[kControllerPitchStep] = 0;
+    c->modwheel_cc = 0;
+    c->breath_cc = 0;
+    c->foot_cc = 0;
+    c->aftertouch_cc = 0;
+    c->portamento_cc = 0;
+    c->portamento_enable_cc = false;
+    c->portamento_gliss_cc = false;
+    c->mpeEnabled = false;
+    c->wheel.range = 99;
+    c->wheel.pitch = true;
+    c->wheel.amp = true;
+    c->wheel.eg = false;
+    c->at.range = 99;
+    c->at.pitch = true;
+    c->at.amp = true;
+    c->at.eg = false;
+    c->breath.range = 99;
+    c->breath.pitch = false;
+    c->breath.amp = true;
+    c->breath.eg = false;
+    c->foot.range = 99;
+    c->foot.pitch = false;
+    c->foot.amp = false;
+    c->foot.eg = false;
+    c->refresh();
+}
+
+/* Render the script straight through the msfa engine, mirroring the
+ * voice bookkeeping of v2_render_block */
+static void render_engine(const uint8_t *patch, golden_entry_t *e) {
+    std::shared_ptr<TuningState> tuning = std::make_shared<TuningState>();
+    FmCore fixed_core;
+    FloatFmCore float_core;
+    fixed_core.setSinePoly(g_sine_poly);
+    fixed_core.setPureKernel(g_pure);
+    Controllers ctrls;
+    setup_controllers(&ctrls, g_float_engine ? (FmCore *)&float_core : &fixed_core);
+    Lfo lfo;
+    memset(&lfo, 0, sizeof(lfo));
+    lfo.reset(patch + 137);
+
+    Dx7Note *voices[GOLDEN_VOICES];
+    int voice_note[GOLDEN_VOICES];
+    for (int v = 0; v < GOLDEN_VOICES; v++) {
+        voices[v] = new Dx7Note(tuning, nullptr);
+        voice_note[v] = -1;
+    }
+
+    int32_t buf[N];
+    uint32_t hash = FNV_INIT;
+    double sum_sq = 0;
+    int sample = 0;
+    int next_voice = 0;
+
+    for (int b = 0; b < SCRIPT_BLOCKS; b++) {
+        for (int i = 0; i < SCRIPT_EVENTS; i++) {
+            const script_event_t *ev = &g_script[i];
+            if (ev->block != b) continue;
+            int note = ev->data1 + (patch[144] - 24);
+            if (note < 0) note = 0;
+            if (note > 127) note = 127;
+            if (ev->status == 0x90) {
+                int v = next_voice++;
+                voices[v]->init(patch, note, ev->data2, 0, &ctrls);
+                voice_note[v] = note;
+                if (v == 0) lfo.keydown();
+            } else if (ev->status == 0x80) {
+                for (int v = 0; v < GOLDEN_VOICES; v++) {
+                    if (voice_note[v] == note) voices[v]->keyup();
+                }
+            } else if (ev->status == 0xB0) {
+                ctrls.modwheel_cc = ev->data2;
+                ctrls.refresh();
+            }
+        }
+
+        for (int sub = 0; sub < MOVE_FRAMES_PER_BLOCK; sub += N) {
+            memset(buf, 0, sizeof(buf));
+            int32_t lfo_val = lfo.getsample();
+            int32_t lfo_delay = lfo.getdelay();
+            for (int v = 0; v < GOLDEN_VOICES; v++) {
+                if (voice_note[v] >= 0 || voices[v]->isPlaying()) {
+                    voices[v]->compute(buf, lfo_val, lfo_delay, &ctrls);
+                    if (!voices[v]->isPlaying()) voice_note[v] = -1;
+                }
+            }
+            for (int i = 0; i < N; i++, sample++) {
+                hash = fnv_add(hash, (uint32_t)buf[i]);
+                sum_sq += (double)buf[i] * (double)buf[i];
+                for (int x = 0; x < 2; x++) {
+                    int k = sample - excerpt_pos[x];
+                    if (k >= 0 && k < EXCERPT_LEN) e->excerpt[x * EXCERPT_LEN + k] = buf[i];
+                }
+            }
+        }
+    }
+
+    for (int v = 0; v < GOLDEN_VOICES; v++) delete voices[v];
+    e->engine_hash = hash;
+    e->rms = (uint32_t)floor(sqrt(sum_sq / SCRIPT_SAMPLES) + 0.5);
+}
+
+/* Render the same script through a fresh plugin instance. Host blocks are
+ * g_frames long; each event goes in before the host block holding the first
+ * sample of its 128-frame script block, so sizes that divide 128 must hash
+ * the same as the corpus. With --timed the events carry their frame offset
+ * instead, which matches the corpus for any host block size. */
+static void render_plugin(plugin_api_v2_t *api, const char *module_dir, int bank, int preset,
+                          golden_entry_t *e) {
+    void *inst = api->create_instance(module_dir, NULL);
+    char val[16];
+    snprintf(val, sizeof(val), "%d", bank);
+    api->set_param(inst, "syx_bank_index", val);
+    snprintf(val, sizeof(val), "%d", preset);
+    api->set_param(inst, "preset", val);
+    if (g_float_engine) api->set_param(inst, "engine", "float");
+    api->set_param(inst, "sine", g_sine_poly ? "poly" : "table");
+    if (g_pure != FmOpKernel::PURE_SINE) {
+        api->set_param(inst, "pure_kernel", g_pure == FmOpKernel::PURE_DIFF ? "diff" : "resonator");
+    }
+
+    int16_t out[MAX_HOST_FRAMES * 2];
+    uint32_t hash = FNV_INIT;
+    uint8_t msgs[SCRIPT_EVENTS][3];
+    dx7_midi_event_t timed[SCRIPT_EVENTS];
+    for (int pos = 0; pos < SCRIPT_SAMPLES; pos += g_frames) {
+        int frames = SCRIPT_SAMPLES - pos < g_frames ? SCRIPT_SAMPLES - pos : g_frames;
+        int count = 0;
+        for (int i = 0; i < SCRIPT_EVENTS; i++) {
+            const script_event_t *ev = &g_script[i];
+            int at = ev->block * MOVE_FRAMES_PER_BLOCK;
+            if (at < pos || at >= pos + frames) continue;
+            msgs[i][0] = ev->status;
+            msgs[i][1] = ev->data1;
+            msgs[i][2] = ev->data2;
+            if (g_timed) {
+                timed[count].offset = at - pos;
+                timed[count].source = MOVE_MIDI_SOURCE_EXTERNAL;
+                timed[count].msg = msgs[i];
+                timed[count].len = 3;
+                count++;
+            } else {
+                api->on_midi(inst, msgs[i], 3, MOVE_MIDI_SOURCE_EXTERNAL);
+            }
+        }
+        if (g_timed) {
+            dx7_render_block_events(inst, out, frames, timed, count);
+        } else {
+            api->render_block(inst, out, frames);
+        }
+        for (int i = 0; i < frames * 2; i++) {
+            hash = fnv_add(hash, (uint32_t)(uint16_t)out[i]);
+        }
+    }
+    api->destroy_instance(inst);
+    e->plugin_hash = hash;
+}
+
+static void format_entry(const golden_entry_t *e, FILE *f) {
+    fprintf(f, "%s %d %08x %08x %u", e->bank, e->preset, e->engine_hash, e->plugin_hash, e->rms);
+    for (int i = 0; i < 2 * EXCERPT_LEN; i++) fprintf(f, " %d", e->excerpt[i]);
+    fprintf(f, "\n");
+}
+
+static int parse_entry(const char *line, golden_entry_t *e) {
+    const char *fmt = "%127s %d %x %x %u %d %d %d %d %d %d %d %d";
+    int n = sscanf(line, fmt, e->bank, &e->preset, &e->engine_hash, &e->plugin_hash, &e->rms,
+                   &e->excerpt[0], &e->excerpt[1], &e->excerpt[2], &e->excerpt[3],
+                   &e->excerpt[4], &e->excerpt[5], &e->excerpt[6], &e->excerpt[7]);
+    return n == 5 + 2 * EXCERPT_LEN ? 0 : -1;
+}
+
+static void usage(const char *argv0) {
+    fprintf(stderr,
+        "usage: %s (--write FILE | --check FILE) [options]\n"
+        "  --module-dir DIR   directory containing banks/ (default: .)\n"
+        "  --tolerance N      accept engine drift up to N (Q24 units) in the\n"
+        "                     excerpts and 0.1%% in RMS (default: 0, bit-exact)\n"
+        "  --sine table|poly  operator sine source (default: table, which the\n"
+        "                     corpus is written with on every build)\n"
+        "  --pure sine|resonator|diff\n"
+        "                     compute_pure kernel (default: sine)\n"
+        "  --engine q24|float render engine (default: q24)\n"
+        "  --frames F         host block size for the plugin render, 1 to %d\n"
+        "                     (default: %d; sizes dividing %d match the corpus)\n"
+        "  --timed            pass the script as timed events (render_block_events)\n",
+        argv0, MAX_HOST_FRAMES, MOVE_FRAMES_PER_BLOCK, MOVE_FRAMES_PER_BLOCK);
+}
+
+int main(int argc, char **argv) {
+    const char *module_dir = ".";
+    const char *write_path = NULL;
+    const char *check_path = NULL;
+    int tolerance = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--module-dir") == 0 && i + 1 < argc) {
+            module_dir = argv[++i];
+        } else if (strcmp(argv[i], "--write") == 0 && i + 1 < argc) {
+            write_path = argv[++i];
+        } else if (strcmp(argv[i], "--check") == 0 && i + 1 < argc) {
+            check_path = argv[++i];
+        } else if (strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc) {
+            tolerance = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--engine") == 0 && i + 1 < argc) {
+            g_float_engine = strcmp(argv[++i], "float") == 0;
+        } else if (strcmp(argv[i], "--sine") == 0 && i + 1 < argc) {
+            g_sine_poly = strcmp(argv[++i], "poly") == 0;
+        } else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            g_frames = atoi(argv[++i]);
+            if (g_frames < 1) g_frames = 1;
+            if (g_frames > MAX_HOST_FRAMES) g_frames = MAX_HOST_FRAMES;
+        } else if (strcmp(argv[i], "--timed") == 0) {
+            g_timed = true;
+        } else if (strcmp(argv[i], "--pure") == 0 && i + 1 < argc) {
+            i++;
+            if (strcmp(argv[i], "resonator") == 0) g_pure = FmOpKernel::PURE_RESONATOR;
+            else if (strcmp(argv[i], "diff") == 0) g_pure = FmOpKernel::PURE_DIFF;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (!write_path == !check_path) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    host_api_v1_t host;
+    memset(&host, 0, sizeof(host));
+    host.api_version = MOVE_PLUGIN_API_VERSION;
+    host.sample_rate = MOVE_SAMPLE_RATE;
+    host.frames_per_block = g_frames;
+    host.log = host_log;
+    plugin_api_v2_t *api = move_plugin_init_v2(&host);
+
+    /* The first instance initializes the shared tables and lists the banks */
+    void *probe = api->create_instance(module_dir, NULL);
+    char buf[64];
+    int bank_count = 0;
+    if (api->get_param(probe, "syx_bank_count", buf, sizeof(buf)) > 0) bank_count = atoi(buf);
+    if (bank_count <= 0) {
+        fprintf(stderr, "No banks found in %s/banks\n", module_dir);
+        return 1;
+    }
+
+    /* Reference corpus, indexed by position */
+    golden_entry_t *ref = NULL;
+    int ref_count = 0;
+    if (check_path) {
+        FILE *f = fopen(check_path, "r");
+        if (!f) {
+            fprintf(stderr, "Cannot open %s\n", check_path);
+            return 1;
+        }
+        ref = (golden_entry_t *)calloc(bank_count * PATCHES_PER_BANK + 1, sizeof(golden_entry_t));
+        char line[512];
+        while (fgets(line, sizeof(line), f) && ref_count < bank_count * PATCHES_PER_BANK) {
+            if (line[0] == '#' || line[0] == '\n') continue;
+            if (parse_entry(line, &ref[ref_count]) == 0) ref_count++;
+        }
+        fclose(f);
+    }
+
+    FILE *out = NULL;
+    if (write_path) {
+        out = fopen(write_path, "w");
+        if (!out) {
+            fprintf(stderr, "Cannot write %s\n", write_path);
+            return 1;
+        }
+        fprintf(out, "# Dexed golden corpus: bank preset engine_hash plugin_hash rms excerpt[%d]\n",
+                2 * EXCERPT_LEN);
+        fprintf(out, "# Regenerate with ./scripts/bench.sh golden --write\n");
+    }
+
+    int exact = 0, close = 0, differ = 0, missing = 0;
+    double drift_sum = 0, drift_max = 0;
+    for (int b = 0; b < bank_count; b++) {
+        snprintf(buf, sizeof(buf), "%d", b);
+        api->set_param(probe, "syx_bank_index", buf);
+        char bank[128] = "";
+        api->get_param(probe, "syx_bank_name", bank, sizeof(bank));
+
+        char path[768];
+        snprintf(path, sizeof(path), "%s/banks/%s", module_dir, bank);
+        uint8_t patches[PATCHES_PER_BANK][156];
+        if (load_bank(path, patches) != 0) {
+            fprintf(stderr, "Skipping unreadable bank %s\n", bank);
+            continue;
+        }
+
+        for (int p = 0; p < PATCHES_PER_BANK; p++) {
+            golden_entry_t e;
+            memset(&e, 0, sizeof(e));
+            snprintf(e.bank, sizeof(e.bank), "%s", bank);
+            e.preset = p;
+            render_engine(patches[p], &e);
+            render_plugin(api, module_dir, b, p, &e);
+
+            if (out) {
+                format_entry(&e, out);
+                continue;
+            }
+
+            const golden_entry_t *r = NULL;
+            for (int i = 0; i < ref_count; i++) {
+                if (ref[i].preset == p && strcmp(ref[i].bank, bank) == 0) {
+                    r = &ref[i];
+                    break;
+                }
+            }
+            if (!r) {
+                missing++;
+                printf("MISSING %s #%d\n", bank, p);
+                continue;
+            }
+            if (r->engine_hash == e.engine_hash && r->plugin_hash == e.plugin_hash) {
+                exact++;
+                continue;
+            }
+
+            int max_diff = 0;
+            for (int i = 0; i < 2 * EXCERPT_LEN; i++) {
+                int d = abs(r->excerpt[i] - e.excerpt[i]);
+                if (d > max_diff) max_diff = d;
+            }
+            double rms_delta = r->rms ? fabs((double)e.rms - r->rms) / r->rms : (e.rms ? 1.0 : 0.0);
+            drift_sum += rms_delta;
+            if (rms_delta > drift_max) drift_max = rms_delta;
+            bool ok = tolerance > 0 && max_diff <= tolerance && rms_delta <= 0.001;
+            if (ok) {
+                close++;
+            } else {
+                differ++;
+            }
+            printf("%s %s #%d: engine %s, plugin %s, excerpt max diff %d, rms %u -> %u (%.3f%%)\n",
+                   ok ? "CLOSE" : "DIFF", bank, p,
+                   r->engine_hash == e.engine_hash ? "exact" : "changed",
+                   r->plugin_hash == e.plugin_hash ? "exact" : "changed",
+                   max_diff, r->rms, e.rms, rms_delta * 100);
+        }
+    }
+
+    api->destroy_instance(probe);
+
+    if (out) {
+        fclose(out);
+        printf("Wrote %s\n", write_path);
+        return 0;
+    }
+
+    free(ref);
+    if (close || differ) {
+        int compared = exact + close + differ;
+        printf("rms drift: mean %.3f%%, max %.3f%%\n", drift_sum / compared * 100, drift_max * 100);
+    }
+    printf("%d bit-exact, %d close, %d different, %d missing\n", exact, close, differ, missing);
+    return (differ || missing) ? 1 : 0;
+}
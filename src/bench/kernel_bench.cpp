@@ -0,0 +1,320 @@
+/*
+ * FmOpKernel microbenchmark
+ *
+ * Times FmOpKernel::compute, compute_pure and compute_fb and their float
+ * variants in isolation, sweeping add/no-add, flat versus ramped gain,
+ * table versus polynomial sine and every feedback shift; compute_pure also
+ * runs as the resonator and diff recurrences. Each case runs several repetitions and reports the fastest, which is
+ * the most stable figure to compare kernel changes against.
+ *
+ * --accuracy instead measures each sine source and recurrence against the
+ * exact sine, as mean and worst absolute error in Q24 units over a
+ * frequency sweep.
+ *
+ * Built natively by scripts/bench.sh (./scripts/bench.sh kernel).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <math.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_TSC 1
+#endif
+
+#include "msfa/synth.h"
+#include "msfa/aligned_buf.h"
+#include "msfa/fm_op_kernel.h"
+#include "msfa/sin.h"
+#include "msfa/exp2.h"
+
+/* Gains as FmCore::render produces them: Exp2 of a Q24 level */
+#define GAIN_FLAT  (1 << 22)
+#define GAIN_START (1 << 20)
+#define GAIN_END   (1 << 23)
+
+/* ~440 Hz at 44.1 kHz in Q24 phase units per sample */
+#define FREQ_440 167409
+
+typedef enum {
+    KERNEL_COMPUTE = 0,
+    KERNEL_PURE,
+    KERNEL_FB,
+    KERNEL_COMPUTE_FLOAT,
+    KERNEL_PURE_FLOAT,
+    KERNEL_FB_FLOAT
+} kernel_id_t;
+
+static const char *kernel_names[] = {
+    "compute", "compute_pure", "compute_fb",
+    "compute_float", "compute_pure_float", "compute_fb_float"
+};
+
+typedef struct {
+    kernel_id_t kernel;
+    bool add;
+    bool ramp;
+    bool poly;
+    FmOpKernel::PureKernel pure;    /* compute_pure recurrence, PURE_SINE otherwise */
+    int fb_shift;
+} kernel_case_t;
+
+static AlignedBuf<int32_t, N> g_in;
+static AlignedBuf<int32_t, N> g_out;
+static AlignedBuf<float, N> g_in_float;
+static AlignedBuf<float, N> g_out_float;
+
+static inline uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/* Run `calls` kernel invocations, return elapsed ns and TSC ticks */
+static uint64_t run_case(const kernel_case_t *c, int calls, uint64_t *ticks) {
+    int32_t *in = g_in.get();
+    int32_t *out = g_out.get();
+    float *in_float = g_in_float.get();
+    float *out_float = g_out_float.get();
+    int32_t fb_buf[2] = { 0, 0 };
+    int32_t phase = 0;
+    int32_t gain1 = c->ramp ? GAIN_START : GAIN_FLAT;
+    int32_t gain2 = c->ramp ? GAIN_END : GAIN_FLAT;
+
+    uint64_t t0 = now_ns();
+#ifdef HAVE_TSC
+    uint64_t c0 = __rdtsc();
+#endif
+    for (int i = 0; i < calls; i++) {
+        switch (c->kernel) {
+            case KERNEL_COMPUTE:
+                FmOpKernel::compute(out, in, phase, FREQ_440, gain1, gain2, c->add, c->poly);
+                break;
+            case KERNEL_PURE:
+                FmOpKernel::compute_pure(out, phase, FREQ_440, gain1, gain2, c->add, c->poly,
+                                         c->pure);
+                break;
+            case KERNEL_FB:
+                FmOpKernel::compute_fb(out, phase, FREQ_440, gain1, gain2,
+                                       fb_buf, c->fb_shift, c->add);
+                break;
+            case KERNEL_COMPUTE_FLOAT:
+                FmOpKernel::compute_float(out_float, in_float, phase, FREQ_440,
+                                          gain1, gain2, c->add);
+                break;
+            case KERNEL_PURE_FLOAT:
+                FmOpKernel::compute_pure_float(out_float, phase, FREQ_440, gain1, gain2, c->add);
+                break;
+            case KERNEL_FB_FLOAT:
+                FmOpKernel::compute_fb_float(out_float, phase, FREQ_440, gain1, gain2,
+                                             fb_buf, c->fb_shift, c->add);
+                break;
+        }
+        phase += FREQ_440 << LG_N;
+    }
+#ifdef HAVE_TSC
+    *ticks = __rdtsc() - c0;
+#else
+    *ticks = 0;
+#endif
+    return now_ns() - t0;
+}
+
+/*
+ * Sine accuracy of compute_pure at unity gain (output == sine), in the
+ * style of the experiments at the end of fm_op_kernel.cc: mean and worst
+ * absolute error against the exact sine in Q24 units, overall and for
+ * freq < 0.25 (below half Nyquist).
+ */
+static const char *sine_name(const kernel_case_t *c) {
+    if (c->pure == FmOpKernel::PURE_RESONATOR) return "res";
+    if (c->pure == FmOpKernel::PURE_DIFF) return "diff";
+    return c->poly ? "poly" : "table";
+}
+
+static void accuracy_report(void) {
+    const int blocks = 64;
+    const int freqs = 200;
+    const double q24 = 1 << 24;
+    int32_t *out = g_out.get();
+
+    printf("%-6s %10s %8s %10s %8s %10s\n",
+           "sine", "mean", "worst", "mean<.25", "worst", "worst dBFS");
+    /* table, poly, then the two recurrences */
+    for (int src = 0; src < 4; src++) {
+        kernel_case_t c;
+        memset(&c, 0, sizeof(c));
+        c.poly = src == 1;
+        c.pure = src < 2 ? FmOpKernel::PURE_SINE : (FmOpKernel::PureKernel)(src - 1);
+        double sum = 0, sum_low = 0;
+        double worst = 0, worst_low = 0;
+        long n = 0, n_low = 0;
+        for (int f = 0; f < freqs; f++) {
+            /* Log sweep from ~10 Hz to just under Nyquist */
+            int32_t freq = (int32_t)(q24 * 0.0002 * pow(0.4999 / 0.0002, f / (double)(freqs - 1)));
+            int32_t phase = (int32_t)(f * 2654435761u);
+            bool low = freq < (1 << 22);
+            for (int b = 0; b < blocks; b++) {
+                FmOpKernel::compute_pure(out, phase, freq, 1 << 24, 1 << 24, false, c.poly, c.pure);
+                for (int i = 0; i < N; i++) {
+                    uint32_t p = (uint32_t)phase + (uint32_t)i * (uint32_t)freq;
+                    double exact = floor(q24 * sin((p & 0xffffff) * (2 * M_PI / q24)) + 0.5);
+                    double err = fabs(out[i] - exact);
+                    sum += err;
+                    n++;
+                    if (err > worst) worst = err;
+                    if (low) {
+                        sum_low += err;
+                        n_low++;
+                        if (err > worst_low) worst_low = err;
+                    }
+                }
+                phase += freq << LG_N;
+            }
+        }
+        printf("%-6s %10.2f %8.0f %10.2f %8.0f %10.1f\n",
+               sine_name(&c), sum / n, worst, sum_low / n_low, worst_low,
+               20 * log10(worst / q24));
+    }
+    printf("(1 int16 output LSB is 8192 Q24 units of a full-scale carrier)\n");
+}
+
+static void usage(const char *argv0) {
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "  --calls N    kernel calls per repetition (default: 200000)\n"
+        "  --reps N     repetitions per case, fastest is kept (default: 5)\n"
+        "  --ghz F      core clock for cycles/sample (default: TSC on x86)\n"
+        "  --csv        machine-readable output\n"
+        "  --accuracy   sine accuracy report instead of timings\n",
+        argv0);
+}
+
+int main(int argc, char **argv) {
+    int calls = 200000;
+    int reps = 5;
+    double ghz = 0;
+    int csv = 0;
+    int accuracy = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--calls") == 0 && i + 1 < argc) {
+            calls = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--reps") == 0 && i + 1 < argc) {
+            reps = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--ghz") == 0 && i + 1 < argc) {
+            ghz = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--csv") == 0) {
+            csv = 1;
+        } else if (strcmp(argv[i], "--accuracy") == 0) {
+            accuracy = 1;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (calls <= 0 || reps <= 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    Exp2::init();
+    Sin::init();
+
+    if (accuracy) {
+        accuracy_report();
+        return 0;
+    }
+
+    /* Modulator input: a full-scale sine like a preceding operator writes */
+    int32_t *in = g_in.get();
+    int32_t mod_phase = 0;
+    for (int i = 0; i < N; i++) {
+        in[i] = Sin::lookup(mod_phase);
+        g_in_float.get()[i] = in[i] * (1.0f / (1 << 24));
+        mod_phase += FREQ_440 * 2;
+    }
+    memset(g_out.get(), 0, N * sizeof(int32_t));
+    memset(g_out_float.get(), 0, N * sizeof(float));
+
+    /* Build the sweep */
+    kernel_case_t cases[128];
+    int ncases = 0;
+    for (int k = KERNEL_COMPUTE; k <= KERNEL_FB_FLOAT; k++) {
+        bool fb = k == KERNEL_FB || k == KERNEL_FB_FLOAT;
+        int shift_lo = fb ? 1 : 0;
+        int shift_hi = fb ? 7 : 0;
+        /* Feedback kernels always use the table, the other float ones the polynomial */
+        int poly_lo = (k == KERNEL_COMPUTE_FLOAT || k == KERNEL_PURE_FLOAT) ? 1 : 0;
+        int poly_hi = fb ? 0 : 1;
+        /* compute_pure adds the resonator and diff recurrences as poly = 2, 3 */
+        if (k == KERNEL_PURE) poly_hi = 3;
+        for (int poly = poly_lo; poly <= poly_hi; poly++) {
+            for (int shift = shift_lo; shift <= shift_hi; shift++) {
+                for (int add = 0; add <= 1; add++) {
+                    for (int ramp = 0; ramp <= 1; ramp++) {
+                        kernel_case_t *c = &cases[ncases++];
+                        c->kernel = (kernel_id_t)k;
+                        c->add = add != 0;
+                        c->ramp = ramp != 0;
+                        c->poly = poly == 1;
+                        c->pure = poly < 2 ? FmOpKernel::PURE_SINE : (FmOpKernel::PureKernel)(poly - 1);
+                        c->fb_shift = shift;
+                    }
+                }
+            }
+        }
+    }
+
+    if (csv) {
+        printf("kernel,add,gain,sine,fb_shift,ns_per_sample,msamples_per_s,cycles_per_sample\n");
+    } else {
+        printf("%-18s %-5s %-5s %-5s %3s %10s %12s %10s\n",
+               "kernel", "mode", "gain", "sine", "fb", "ns/sample", "Msamples/s", "cyc/sample");
+    }
+
+    double samples = (double)calls * N;
+    for (int i = 0; i < ncases; i++) {
+        const kernel_case_t *c = &cases[i];
+        uint64_t best_ns = UINT64_MAX;
+        uint64_t best_ticks = 0;
+
+        /* Warm up tables and caches once before timing */
+        uint64_t ticks;
+        run_case(c, calls / 10 + 1, &ticks);
+        for (int r = 0; r < reps; r++) {
+            uint64_t ns = run_case(c, calls, &ticks);
+            if (ns < best_ns) {
+                best_ns = ns;
+                best_ticks = ticks;
+            }
+        }
+
+        double ns_per_sample = best_ns / samples;
+        double msps = samples / (best_ns / 1e9) / 1e6;
+        double cps = 0;
+        if (ghz > 0) {
+            cps = ns_per_sample * ghz;
+        } else if (best_ticks) {
+            cps = best_ticks / samples;
+        }
+
+        if (csv) {
+            printf("%s,%d,%s,%s,%d,%.4f,%.2f,%.3f\n",
+                   kernel_names[c->kernel], c->add ? 1 : 0, c->ramp ? "ramp" : "flat",
+                   sine_name(c), c->fb_shift, ns_per_sample, msps, cps);
+        } else {
+            char fb[16] = "-";
+            if (c->kernel == KERNEL_FB || c->kernel == KERNEL_FB_FLOAT) snprintf(fb, sizeof(fb), "%d", c->fb_shift);
+            printf("%-18s %-5s %-5s %-5s %3s %10.4f %12.2f %10.3f\n",
+                   kernel_names[c->kernel], c->add ? "add" : "set", c->ramp ? "ramp" : "flat",
+                   sine_name(c), fb, ns_per_sample, msps, cps);
+        }
+    }
+
+    return 0;
+}
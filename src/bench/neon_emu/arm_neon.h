@@ -0,0 +1,224 @@
+/*
+ * Portable stand-in for <arm_neon.h>, covering exactly the intrinsics
+ * src/dsp/msfa/simd.h uses, so the NEON backend can be built and checked
+ * against the golden corpus on a desktop:
+ *
+ *   CXXFLAGS="-D__ARM_NEON -Isrc/bench/neon_emu" ./scripts/bench.sh golden
+ *
+ * Each intrinsic is written as plain scalar C++ following the AArch64
+ * definition of the instruction (wraparound, shift-count, rounding and
+ * saturation rules included), so this checks the NEON code paths and
+ * lane bookkeeping, not the aarch64 compiler or its timing. Never part of
+ * the device build.
+ */
+
+#ifndef DEXED_NEON_EMU_ARM_NEON_H
+#define DEXED_NEON_EMU_ARM_NEON_H
+
+#if defined(__aarch64__) || defined(__arm__)
+#error "neon_emu is for desktop builds; use the real <arm_neon.h> on ARM"
+#endif
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+typedef struct { int16_t v[4]; } int16x4_t;
+typedef struct { int32_t v[2]; } int32x2_t;
+typedef struct { int32_t v[4]; } int32x4_t;
+typedef struct { int64_t v[2]; } int64x2_t;
+typedef struct { float v[4]; } float32x4_t;
+typedef struct { int16x4_t val[2]; } int16x4x2_t;
+typedef struct { int32x4_t val[2]; } int32x4x2_t;
+
+/* Loads, stores and lanes */
+
+static inline int32x4_t vld1q_s32(const int32_t *p) {
+    int32x4_t r;
+    memcpy(r.v, p, sizeof(r.v));
+    return r;
+}
+
+static inline int32x2_t vld1_s32(const int32_t *p) {
+    int32x2_t r;
+    memcpy(r.v, p, sizeof(r.v));
+    return r;
+}
+
+static inline void vst1q_s32(int32_t *p, int32x4_t a) {
+    memcpy(p, a.v, sizeof(a.v));
+}
+
+static inline float32x4_t vld1q_f32(const float *p) {
+    float32x4_t r;
+    memcpy(r.v, p, sizeof(r.v));
+    return r;
+}
+
+static inline void vst1q_f32(float *p, float32x4_t a) {
+    memcpy(p, a.v, sizeof(a.v));
+}
+
+/* Interleaving store: p[2k] = a.val[0] lane k, p[2k + 1] = a.val[1] lane k */
+static inline void vst2_s16(int16_t *p, int16x4x2_t a) {
+    for (int k = 0; k < 4; k++) {
+        p[2 * k] = a.val[0].v[k];
+        p[2 * k + 1] = a.val[1].v[k];
+    }
+}
+
+static inline int32x4_t vdupq_n_s32(int32_t x) {
+    int32x4_t r = { { x, x, x, x } };
+    return r;
+}
+
+static inline float32x4_t vdupq_n_f32(float x) {
+    float32x4_t r = { { x, x, x, x } };
+    return r;
+}
+
+#define vgetq_lane_s32(a, lane) ((a).v[(lane)])
+
+static inline int32x2_t vget_low_s32(int32x4_t a) {
+    int32x2_t r = { { a.v[0], a.v[1] } };
+    return r;
+}
+
+static inline int32x2_t vget_high_s32(int32x4_t a) {
+    int32x2_t r = { { a.v[2], a.v[3] } };
+    return r;
+}
+
+static inline int32x4_t vcombine_s32(int32x2_t lo, int32x2_t hi) {
+    int32x4_t r = { { lo.v[0], lo.v[1], hi.v[0], hi.v[1] } };
+    return r;
+}
+
+/* val[0] = even lanes of a:b, val[1] = odd lanes */
+static inline int32x4x2_t vuzpq_s32(int32x4_t a, int32x4_t b) {
+    int32x4x2_t r = { { { { a.v[0], a.v[2], b.v[0], b.v[2] } },
+                        { { a.v[1], a.v[3], b.v[1], b.v[3] } } } };
+    return r;
+}
+
+static inline float32x4_t vreinterpretq_f32_s32(int32x4_t a) {
+    float32x4_t r;
+    memcpy(r.v, a.v, sizeof(r.v));
+    return r;
+}
+
+static inline int32x4_t vreinterpretq_s32_f32(float32x4_t a) {
+    int32x4_t r;
+    memcpy(r.v, a.v, sizeof(r.v));
+    return r;
+}
+
+/* Integer arithmetic, wrapping modulo 2^32 */
+
+#define NEON_EMU_BINARY_S32(name, expr)                          \
+    static inline int32x4_t name(int32x4_t a, int32x4_t b) {     \
+        int32x4_t r;                                             \
+        for (int k = 0; k < 4; k++) {                            \
+            uint32_t x = (uint32_t)a.v[k], y = (uint32_t)b.v[k]; \
+            r.v[k] = (int32_t)(expr);                            \
+        }                                                        \
+        return r;                                                \
+    }
+
+NEON_EMU_BINARY_S32(vaddq_s32, x + y)
+NEON_EMU_BINARY_S32(vsubq_s32, x - y)
+NEON_EMU_BINARY_S32(vmulq_s32, x * y)
+NEON_EMU_BINARY_S32(vandq_s32, x & y)
+NEON_EMU_BINARY_S32(veorq_s32, x ^ y)
+
+#undef NEON_EMU_BINARY_S32
+
+/* SSHR: arithmetic shift right by 1..32 */
+static inline int32_t neon_emu_sra(int32_t x, int n) {
+    return n >= 32 ? (x < 0 ? -1 : 0) : (x >> n);
+}
+
+static inline int32x4_t vshlq_n_s32(int32x4_t a, int n) {
+    int32x4_t r;
+    for (int k = 0; k < 4; k++) r.v[k] = (int32_t)((uint32_t)a.v[k] << n);
+    return r;
+}
+
+static inline int32x4_t vshrq_n_s32(int32x4_t a, int n) {
+    int32x4_t r;
+    for (int k = 0; k < 4; k++) r.v[k] = neon_emu_sra(a.v[k], n);
+    return r;
+}
+
+/* SSHL: the count is the signed low byte of each lane of b, negative
+ * shifting right (arithmetically); counts past the width saturate */
+static inline int32x4_t vshlq_s32(int32x4_t a, int32x4_t b) {
+    int32x4_t r;
+    for (int k = 0; k < 4; k++) {
+        int n = (int8_t)(b.v[k] & 0xff);
+        if (n >= 0) {
+            r.v[k] = n >= 32 ? 0 : (int32_t)((uint32_t)a.v[k] << n);
+        } else {
+            r.v[k] = neon_emu_sra(a.v[k], -n);
+        }
+    }
+    return r;
+}
+
+/* SMULL: full 64-bit products */
+static inline int64x2_t vmull_s32(int32x2_t a, int32x2_t b) {
+    int64x2_t r = { { (int64_t)a.v[0] * b.v[0], (int64_t)a.v[1] * b.v[1] } };
+    return r;
+}
+
+/* SHRN: shift right by 1..32 and keep the low 32 bits */
+static inline int32x2_t vshrn_n_s64(int64x2_t a, int n) {
+    int32x2_t r;
+    for (int k = 0; k < 2; k++) r.v[k] = (int32_t)(uint32_t)((uint64_t)a.v[k] >> n);
+    return r;
+}
+
+/* SQXTN: saturate to int16 */
+static inline int16x4_t vqmovn_s32(int32x4_t a) {
+    int16x4_t r;
+    for (int k = 0; k < 4; k++) {
+        int32_t x = a.v[k];
+        r.v[k] = (int16_t)(x > INT16_MAX ? INT16_MAX : x < INT16_MIN ? INT16_MIN : x);
+    }
+    return r;
+}
+
+/* Float arithmetic, IEEE single with round to nearest like the default FPCR */
+
+static inline float32x4_t vaddq_f32(float32x4_t a, float32x4_t b) {
+    float32x4_t r;
+    for (int k = 0; k < 4; k++) r.v[k] = a.v[k] + b.v[k];
+    return r;
+}
+
+static inline float32x4_t vmulq_f32(float32x4_t a, float32x4_t b) {
+    float32x4_t r;
+    for (int k = 0; k < 4; k++) r.v[k] = a.v[k] * b.v[k];
+    return r;
+}
+
+static inline float32x4_t vcvtq_f32_s32(int32x4_t a) {
+    float32x4_t r;
+    for (int k = 0; k < 4; k++) r.v[k] = (float)a.v[k];
+    return r;
+}
+
+/* FCVTNS: round to nearest, ties to even, saturating; NaN gives 0 */
+static inline int32x4_t vcvtnq_s32_f32(float32x4_t a) {
+    int32x4_t r;
+    for (int k = 0; k < 4; k++) {
+        float x = a.v[k];
+        if (x != x) r.v[k] = 0;
+        else if (x >= 2147483648.0f) r.v[k] = INT32_MAX;
+        else if (x < -2147483648.0f) r.v[k] = INT32_MIN;
+        else r.v[k] = (int32_t)nearbyintf(x);
+    }
+    return r;
+}
+
+#endif  /* DEXED_NEON_EMU_ARM_NEON_H */
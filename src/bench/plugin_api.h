@@ -0,0 +1,64 @@
+/*
+ * Move plugin API definitions for the offline tools in src/bench
+ *
+ * Mirrors the copy inlined at the top of src/dsp/dx7_plugin.cpp; keep the
+ * two in sync when the plugin API changes.
+ */
+
+#ifndef DEXED_BENCH_PLUGIN_API_H
+#define DEXED_BENCH_PLUGIN_API_H
+
+#include <stdint.h>
+
+extern "C" {
+#define MOVE_PLUGIN_API_VERSION 1
+#define MOVE_SAMPLE_RATE 44100
+#define MOVE_FRAMES_PER_BLOCK 128
+#define MOVE_MIDI_SOURCE_INTERNAL 0
+#define MOVE_MIDI_SOURCE_EXTERNAL 2
+
+typedef struct host_api_v1 {
+    uint32_t api_version;
+    int sample_rate;
+    int frames_per_block;
+    uint8_t *mapped_memory;
+    int audio_out_offset;
+    int audio_in_offset;
+    void (*log)(const char *msg);
+    int (*midi_send_internal)(const uint8_t *msg, int len);
+    int (*midi_send_external)(const uint8_t *msg, int len);
+} host_api_v1_t;
+
+#define MOVE_PLUGIN_API_VERSION_2 2
+
+typedef struct plugin_api_v2 {
+    uint32_t api_version;
+    void* (*create_instance)(const char *module_dir, const char *json_defaults);
+    void (*destroy_instance)(void *instance);
+    void (*on_midi)(void *instance, const uint8_t *msg, int len, int source);
+    void (*set_param)(void *instance, const char *key, const char *val);
+    int (*get_param)(void *instance, const char *key, char *buf, int buf_len);
+    int (*get_error)(void *instance, char *buf, int buf_len);
+    void (*render_block)(void *instance, int16_t *out_interleaved_lr, int frames);
+} plugin_api_v2_t;
+
+plugin_api_v2_t* move_plugin_init_v2(const host_api_v1_t *host);
+
+/* Dexed extension: render_block with MIDI stamped by frame offset, applied at
+ * the next engine block boundary */
+typedef struct dx7_midi_event {
+    int offset;             /* Frame within the block the event belongs to */
+    int source;             /* MOVE_MIDI_SOURCE_* */
+    const uint8_t *msg;
+    int len;
+} dx7_midi_event_t;
+
+void dx7_render_block_events(void *instance, int16_t *out_interleaved_lr, int frames,
+                             const dx7_midi_event_t *events, int count);
+
+/* Dexed extension: float32 output per channel, 1.0 = int16 full scale */
+void dx7_render_block_float(void *instance, float *out_l, float *out_r, int frames,
+                            const dx7_midi_event_t *events, int count);
+}
+
+#endif  /* DEXED_BENCH_PLUGIN_API_H */
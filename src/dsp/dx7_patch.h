@@ -0,0 +1,89 @@
+/*
+ * DX7 VMEM patch unpacking
+ *
+ * Shared by the plugin and the offline tools in src/bench so both read
+ * .syx banks the same way.
+ */
+
+#ifndef DEXED_DX7_PATCH_H
+#define DEXED_DX7_PATCH_H
+
+#include <stdint.h>
+
+/* Unpack a 128-byte packed DX7 voice to 156-byte format */
+static inline void unpack_patch(const uint8_t *packed, uint8_t *unpacked) {
+    /* Operators 1-6 - same order as Dexed (no reversal) */
+    for (int op = 0; op < 6; op++) {
+        int p = op * 17;  /* packed offset */
+        int u = op * 21;  /* unpacked offset - same order as packed */
+
+        /* EG rates */
+        unpacked[u + 0] = packed[p + 0] & 0x7f;
+        unpacked[u + 1] = packed[p + 1] & 0x7f;
+        unpacked[u + 2] = packed[p + 2] & 0x7f;
+        unpacked[u + 3] = packed[p + 3] & 0x7f;
+
+        /* EG levels */
+        unpacked[u + 4] = packed[p + 4] & 0x7f;
+        unpacked[u + 5] = packed[p + 5] & 0x7f;
+        unpacked[u + 6] = packed[p + 6] & 0x7f;
+        unpacked[u + 7] = packed[p + 7] & 0x7f;
+
+        /* Keyboard scaling */
+        unpacked[u + 8] = packed[p + 8] & 0x7f;    /* BP */
+        unpacked[u + 9] = packed[p + 9] & 0x7f;    /* LD */
+        unpacked[u + 10] = packed[p + 10] & 0x7f;  /* RD */
+        unpacked[u + 11] = packed[p + 11] & 0x03;  /* LC */
+        unpacked[u + 12] = (packed[p + 11] >> 2) & 0x03;  /* RC */
+
+        /* Other */
+        unpacked[u + 13] = (packed[p + 12] >> 0) & 0x07;  /* Rate scaling */
+        unpacked[u + 14] = (packed[p + 13] >> 0) & 0x03;  /* Amp mod sens */
+        unpacked[u + 15] = (packed[p + 13] >> 2) & 0x07;  /* Key vel sens */
+        unpacked[u + 16] = packed[p + 14] & 0x7f;  /* Output level */
+        unpacked[u + 17] = (packed[p + 15] >> 0) & 0x01;  /* Osc mode */
+        unpacked[u + 18] = (packed[p + 15] >> 1) & 0x1f;  /* Freq coarse */
+        unpacked[u + 19] = packed[p + 16] & 0x7f;  /* Freq fine */
+        unpacked[u + 20] = (packed[p + 12] >> 3) & 0x0f;  /* Detune */
+    }
+
+    /* Global parameters (offset 102 in packed) */
+    int p = 102;
+
+    /* Pitch EG */
+    unpacked[126] = packed[p + 0] & 0x7f;
+    unpacked[127] = packed[p + 1] & 0x7f;
+    unpacked[128] = packed[p + 2] & 0x7f;
+    unpacked[129] = packed[p + 3] & 0x7f;
+    unpacked[130] = packed[p + 4] & 0x7f;
+    unpacked[131] = packed[p + 5] & 0x7f;
+    unpacked[132] = packed[p + 6] & 0x7f;
+    unpacked[133] = packed[p + 7] & 0x7f;
+
+    /* Algorithm: byte 110, bits 0-4 */
+    unpacked[134] = packed[p + 8] & 0x1f;
+    /* Feedback: byte 111, bits 0-2 */
+    unpacked[135] = packed[p + 9] & 0x07;
+    /* Osc Key Sync: byte 111, bit 3 */
+    unpacked[136] = (packed[p + 9] >> 3) & 0x01;
+
+    /* LFO */
+    unpacked[137] = packed[p + 10] & 0x7f;  /* Speed */
+    unpacked[138] = packed[p + 11] & 0x7f;  /* Delay */
+    unpacked[139] = packed[p + 12] & 0x7f;  /* PMD */
+    unpacked[140] = packed[p + 13] & 0x7f;  /* AMD */
+    /* Byte 116: bit 0 = LFO sync, bits 1-3 = LFO wave, bits 4-6 = LFO PMS */
+    unpacked[141] = packed[p + 14] & 0x01;          /* LFO sync (bit 0) */
+    unpacked[142] = (packed[p + 14] >> 1) & 0x07;   /* LFO wave (bits 1-3) */
+    unpacked[143] = (packed[p + 14] >> 4) & 0x07;   /* LFO PMS (bits 4-6) */
+
+    /* Transpose */
+    unpacked[144] = packed[p + 15] & 0x7f;
+
+    /* Name (10 chars) */
+    for (int i = 0; i < 10; i++) {
+        unpacked[145 + i] = packed[p + 16 + i] & 0x7f;
+    }
+}
+
+#endif  /* DEXED_DX7_PATCH_H */
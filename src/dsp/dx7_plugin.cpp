@@ -50,11 +50,32 @@ typedef struct plugin_api_v2 {
     int (*get_error)(void *instance, char *buf, int buf_len);
     void (*render_block)(void *instance, int16_t *out_interleaved_lr, int frames);
 } plugin_api_v2_t;
+
+/* Dexed extension: render_block with MIDI stamped by frame offset. Hosts that
+ * know the offsets of their events look up dx7_render_block_events and pass
+ * them here instead of calling on_midi before render_block. Scheduling is
+ * block-quantized: an event starts with the first engine block at or after
+ * its offset, up to N - 1 frames late. */
+typedef struct dx7_midi_event {
+    int offset;             /* Frame within the block the event belongs to */
+    int source;             /* MOVE_MIDI_SOURCE_* */
+    const uint8_t *msg;
+    int len;
+} dx7_midi_event_t;
+
+void dx7_render_block_events(void *instance, int16_t *out_interleaved_lr, int frames,
+                             const dx7_midi_event_t *events, int count);
+
+/* Dexed extension: float32 output, one buffer per channel (out_r may be NULL
+ * for mono), 1.0 = int16 full scale and not clipped. events may be NULL. */
+void dx7_render_block_float(void *instance, float *out_l, float *out_r, int frames,
+                            const dx7_midi_event_t *events, int count);
 }
 
 /* msfa FM engine */
 #include "msfa/synth.h"
 #include "msfa/fm_core.h"
+#include "msfa/fm_op_kernel.h"
 #include "msfa/dx7note.h"
 #include "msfa/lfo.h"
 #include "msfa/env.h"
@@ -64,6 +85,11 @@ typedef struct plugin_api_v2 {
 #include "msfa/pitchenv.h"
 #include "msfa/porta.h"
 #include "msfa/tuning.h"
+#include "msfa/simd.h"
+
+#include "dx7_patch.h"
+#include "perf_stats.h"
+#include "trace_ring.h"
 
 /* Constants */
 #define MAX_VOICES 16
@@ -78,6 +104,86 @@ typedef struct {
     char name[128];
 } syx_bank_entry_t;
 
+/* Render stages timed when perf_stats is enabled */
+enum {
+    PERF_LFO = 0,       /* Lfo::getsample + getdelay */
+    PERF_VOICE,         /* One Dx7Note::compute call (includes fm_render) */
+    PERF_FM_RENDER,     /* One FmCore::render call */
+    PERF_OUTPUT,        /* int16/float conversion of one stretch of render_buffer */
+    PERF_BLOCK,         /* Whole v2_render_block call */
+    PERF_STAGE_COUNT
+};
+
+static const char *perf_stage_names[PERF_STAGE_COUNT] = {
+    "lfo", "voice_compute", "fm_render", "output", "block"
+};
+
+/* Per-voice activity since the voice's last note-on (voice_stats param) */
+typedef struct {
+    uint64_t blocks;        /* N-sample blocks rendered */
+    uint64_t ops_rendered;  /* Operator-blocks computed */
+    uint64_t ops_skipped;   /* Operator-blocks under FmCore's level threshold */
+    uint64_t render_ns;     /* Only accumulated while perf_stats is on */
+    int last_ops;           /* Operators computed in the latest block */
+    bool stolen;            /* Note-on took over a still-sounding voice */
+} voice_stats_t;
+
+/* Note-on to first rendered sample, in frames (midi_latency param) */
+typedef struct {
+    uint64_t notes;
+    uint64_t sum;
+    int max;
+    int last;
+} latency_stats_t;
+
+/* Phases of v2_create_instance; scan and load run later in fast-start mode */
+enum {
+    CREATE_ALLOC = 0,   /* Instance allocation and parameter defaults */
+    CREATE_TABLES,      /* Exp2/Sin/Freqlut/... tables (first instance only) */
+    CREATE_VOICES,      /* Dx7Note allocation and init patch */
+    CREATE_SCAN,        /* scan_syx_banks */
+    CREATE_LOAD,        /* First bank load and preset select */
+    CREATE_TOTAL,       /* v2_create_instance itself */
+    CREATE_PHASE_COUNT
+};
+
+static const char *create_phase_names[CREATE_PHASE_COUNT] = {
+    "alloc", "tables", "voices", "scan", "load", "total"
+};
+
+/* Lookup tables are process-wide and only depend on the sample rate. The
+ * function-local static runs its initializer exactly once, even when
+ * instances are created on several threads; later callers wait for it, and
+ * the tables are never rewritten while another instance reads them. */
+static void init_tables(void) {
+    static const bool ready = [] {
+        Exp2::init();
+        Sin::init();
+        Lfo::init(MOVE_SAMPLE_RATE);
+        Freqlut::init(MOVE_SAMPLE_RATE);
+        PitchEnv::init(MOVE_SAMPLE_RATE);
+        Env::init_sr(MOVE_SAMPLE_RATE);
+        Porta::init_sr(MOVE_SAMPLE_RATE);
+        return true;
+    }();
+    (void)ready;
+}
+
+/* FmCore wrapper that times each render call of the core it forwards to.
+ * Installed as controllers.core while perf_stats is enabled. */
+class TimedFmCore : public FmCore {
+public:
+    FmCore *inner;
+    perf_stage_t *stage;
+
+    void render(int32_t *output, FmOpParams *params, int algorithm,
+                int32_t *fb_buf, int32_t feedback_shift, bool add) override {
+        uint64_t t0 = perf_now_ns();
+        inner->render(output, params, algorithm, fb_buf, feedback_shift, add);
+        perf_stage_add(stage, perf_now_ns() - t0);
+    }
+};
+
 /* Host API reference */
 static const host_api_v1_t *g_host = NULL;
 
@@ -90,82 +196,6 @@ static void plugin_log(const char *msg) {
     }
 }
 
-/* Unpack a 128-byte packed DX7 voice to 156-byte format */
-static void unpack_patch(const uint8_t *packed, uint8_t *unpacked) {
-    /* Operators 1-6 - same order as Dexed (no reversal) */
-    for (int op = 0; op < 6; op++) {
-        int p = op * 17;  /* packed offset */
-        int u = op * 21;  /* unpacked offset - same order as packed */
-
-        /* EG rates */
-        unpacked[u + 0] = packed[p + 0] & 0x7f;
-        unpacked[u + 1] = packed[p + 1] & 0x7f;
-        unpacked[u + 2] = packed[p + 2] & 0x7f;
-        unpacked[u + 3] = packed[p + 3] & 0x7f;
-
-        /* EG levels */
-        unpacked[u + 4] = packed[p + 4] & 0x7f;
-        unpacked[u + 5] = packed[p + 5] & 0x7f;
-        unpacked[u + 6] = packed[p + 6] & 0x7f;
-        unpacked[u + 7] = packed[p + 7] & 0x7f;
-
-        /* Keyboard scaling */
-        unpacked[u + 8] = packed[p + 8] & 0x7f;    /* BP */
-        unpacked[u + 9] = packed[p + 9] & 0x7f;    /* LD */
-        unpacked[u + 10] = packed[p + 10] & 0x7f;  /* RD */
-        unpacked[u + 11] = packed[p + 11] & 0x03;  /* LC */
-        unpacked[u + 12] = (packed[p + 11] >> 2) & 0x03;  /* RC */
-
-        /* Other */
-        unpacked[u + 13] = (packed[p + 12] >> 0) & 0x07;  /* Rate scaling */
-        unpacked[u + 14] = (packed[p + 13] >> 0) & 0x03;  /* Amp mod sens */
-        unpacked[u + 15] = (packed[p + 13] >> 2) & 0x07;  /* Key vel sens */
-        unpacked[u + 16] = packed[p + 14] & 0x7f;  /* Output level */
-        unpacked[u + 17] = (packed[p + 15] >> 0) & 0x01;  /* Osc mode */
-        unpacked[u + 18] = (packed[p + 15] >> 1) & 0x1f;  /* Freq coarse */
-        unpacked[u + 19] = packed[p + 16] & 0x7f;  /* Freq fine */
-        unpacked[u + 20] = (packed[p + 12] >> 3) & 0x0f;  /* Detune */
-    }
-
-    /* Global parameters (offset 102 in packed) */
-    int p = 102;
-
-    /* Pitch EG */
-    unpacked[126] = packed[p + 0] & 0x7f;
-    unpacked[127] = packed[p + 1] & 0x7f;
-    unpacked[128] = packed[p + 2] & 0x7f;
-    unpacked[129] = packed[p + 3] & 0x7f;
-    unpacked[130] = packed[p + 4] & 0x7f;
-    unpacked[131] = packed[p + 5] & 0x7f;
-    unpacked[132] = packed[p + 6] & 0x7f;
-    unpacked[133] = packed[p + 7] & 0x7f;
-
-    /* Algorithm: byte 110, bits 0-4 */
-    unpacked[134] = packed[p + 8] & 0x1f;
-    /* Feedback: byte 111, bits 0-2 */
-    unpacked[135] = packed[p + 9] & 0x07;
-    /* Osc Key Sync: byte 111, bit 3 */
-    unpacked[136] = (packed[p + 9] >> 3) & 0x01;
-
-    /* LFO */
-    unpacked[137] = packed[p + 10] & 0x7f;  /* Speed */
-    unpacked[138] = packed[p + 11] & 0x7f;  /* Delay */
-    unpacked[139] = packed[p + 12] & 0x7f;  /* PMD */
-    unpacked[140] = packed[p + 13] & 0x7f;  /* AMD */
-    /* Byte 116: bit 0 = LFO sync, bits 1-3 = LFO wave, bits 4-6 = LFO PMS */
-    unpacked[141] = packed[p + 14] & 0x01;          /* LFO sync (bit 0) */
-    unpacked[142] = (packed[p + 14] >> 1) & 0x07;   /* LFO wave (bits 1-3) */
-    unpacked[143] = (packed[p + 14] >> 4) & 0x07;   /* LFO PMS (bits 4-6) */
-
-    /* Transpose */
-    unpacked[144] = packed[p + 15] & 0x7f;
-
-    /* Name (10 chars) */
-    for (int i = 0; i < 10; i++) {
-        unpacked[145 + i] = packed[p + 16 + i] & 0x7f;
-    }
-}
-
 /* ========================================================================
  * PLUGIN API V2 - INSTANCE-BASED (for multi-instance support)
  * ======================================================================== */
@@ -184,8 +214,9 @@ typedef struct {
     int active_voices;
     int output_level;
 
-    /* Bank management */
-    syx_bank_entry_t syx_banks[MAX_SYX_BANKS];
+    /* Bank management; the list grows on demand up to MAX_SYX_BANKS */
+    syx_bank_entry_t *syx_banks;
+    int syx_bank_capacity;
     int syx_bank_count;
     int syx_bank_index;
 
@@ -241,17 +272,31 @@ typedef struct {
     /* Controllers */
     Controllers controllers;
 
-    /* FM core and LFO */
+    /* FM cores (Q24 and float32, engine param) and LFO */
     FmCore fm_core;
+    FloatFmCore float_core;
+    bool float_engine;
     Lfo lfo;
 
     /* Voices */
     Dx7Note* voices[MAX_VOICES];
     int voice_note[MAX_VOICES];
     int voice_velocity[MAX_VOICES];
-    int voice_age[MAX_VOICES];
     bool voice_sustained[MAX_VOICES];
-    int age_counter;
+    voice_stats_t voice_stats[MAX_VOICES];
+
+    /* Voice lists: free voices on a stack, held voices (voice_note >= 0) on
+     * an LRU list in note-on order (head is stolen first) and on a chain
+     * per note for note-off. -1 ends a list. */
+    int free_voices[MAX_VOICES];
+    int free_count;
+    int lru_prev[MAX_VOICES];
+    int lru_next[MAX_VOICES];
+    int lru_head;
+    int lru_tail;
+    int note_prev[MAX_VOICES];
+    int note_next[MAX_VOICES];
+    int note_head[128];
     bool sustain_pedal;
 
     /* Patches */
@@ -259,13 +304,124 @@ typedef struct {
     uint8_t patches[MAX_PATCHES][DX7_PATCH_SIZE];
     char patch_names[MAX_PATCHES][11];
 
-    /* Render buffer */
+    /* Render buffer; samples before render_pos have been output */
     int32_t render_buffer[N];
+    int render_pos;
+
+    /* Idle: the last engine block had no voice sounding, so render_buffer
+     * is silent and render skips the engine until the next note-on. The
+     * LFO catches up on idle_frames then. */
+    bool idle;
+    uint64_t idle_frames;
+
+    /* Output gain in Q16 (65536 = output_level 100). A level change ramps
+     * from out_gain_from to out_gain_to over N frames. */
+    int32_t out_gain_from;
+    int32_t out_gain_to;            /* -1 until the first render */
+    int out_ramp_pos;               /* Frames into the ramp, N = settled */
+
+    /* MIDI timing (midi_latency param), in output frames */
+    uint64_t stream_pos;            /* Frames output so far */
+    int64_t event_time;             /* Frame a timed event is due at, -1 = on_midi */
+    uint64_t block_wall_ns;         /* perf_now_ns() as the last render_block began, 0 = none */
+    uint64_t block_wall_pos;        /* stream_pos at that point */
+    latency_stats_t latency_timed;  /* dx7_render_block_events */
+    latency_stats_t latency_midi;   /* on_midi */
+    volatile bool latency_reset_pending;
+
+    /* Per-stage render timing (perf_stats param) */
+    bool perf_enabled;
+    volatile bool perf_reset_pending;
+    TimedFmCore perf_core;
+    perf_stage_t perf[PERF_STAGE_COUNT];
+
+    /* Block render time against the real-time budget (render_time param) */
+    perf_hist_t render_hist;
+    int render_threshold_pct;
+    volatile bool render_hist_reset_pending;
+
+    /* Event trace (trace / trace_dump params) */
+    trace_ring_t trace;
+
+    /* Batch feedback operators across voices (voice_batch param) */
+    bool voice_batch;
+
+    /* Early retirement of inaudible release tails (retire_floor param) */
+    int retire_floor_db;            /* dBFS, 0 = off */
+    int64_t retire_thresh;          /* Carrier gain * output_level below which a tail retires */
+    bool voice_retired[MAX_VOICES]; /* Retired, envelopes still tracked for retire_stats */
+    uint64_t retired_voices;
+    uint64_t retire_saved_blocks;   /* N-sample voice-blocks retirement skipped */
+    volatile bool retire_reset_pending;
+    int32_t fade_buffer[N];
+
+    /* Creation phase timing (create_time param) and fast-start state */
+    uint64_t create_ns[CREATE_PHASE_COUNT];
+    bool fast_start;
+    bool banks_scanned;     /* scan_syx_banks has run */
+    bool bank_loaded;       /* A bank (or patches.syx) has been loaded */
+    bool patch_edited;      /* current_patch was edited since create/preset select */
+    bool init_patch;        /* Playing the built-in init patch, not a bank preset */
 
     /* Load error state */
     char load_error[256];
 } dx7_instance_t;
 
+/* Core the voices render through, selected by the engine param */
+static FmCore *engine_core(dx7_instance_t *inst) {
+    return inst->float_engine ? (FmCore *)&inst->float_core : &inst->fm_core;
+}
+
+/* Point controllers.core (and the perf_stats wrapper) at the engine core */
+static void route_core(dx7_instance_t *inst) {
+    inst->perf_core.inner = engine_core(inst);
+    inst->controllers.core = inst->perf_enabled ? (FmCore *)&inst->perf_core : engine_core(inst);
+}
+
+/* Retire released voices whose carriers can no longer reach db dBFS */
+static void set_retire_floor(dx7_instance_t *inst, int db) {
+    if (db > 0) db = 0;
+    if (db < -144) db = -144;
+    inst->retire_floor_db = db;
+    /* Full-scale int16 output is a render_buffer value of 1 << 28 at output_level 100 */
+    inst->retire_thresh = db == 0 ? 0 : (int64_t)(pow(10.0, db / 20.0) * (double)(1 << 28) * 100.0);
+}
+
+/* Whether voice v is released and its remaining tail is under the floor */
+static bool tail_inaudible(dx7_instance_t *inst, int v) {
+    if (inst->retire_thresh == 0 || inst->voice_sustained[v]) return false;
+    int32_t peak = inst->voices[v]->releasePeak();
+    return peak != INT32_MAX && (int64_t)peak * inst->output_level < inst->retire_thresh;
+}
+
+/* Frames until the output goes silent if no more MIDI arrives, -1 if it
+ * will not (a key or the pedal holds a voice, or a carrier sustains at
+ * L4). An upper bound from the carrier envelopes: a voice is done when
+ * they end or, with retire_floor on, when each is below 1/6 of the floor. */
+static int tail_frames(dx7_instance_t *inst) {
+    if (inst->idle) return 0;
+
+    int32_t floor = -1;
+    if (inst->retire_thresh != 0 && inst->output_level > 0) {
+        /* Carrier level whose Exp2 gain is 1/6 of the floor (6 carriers at most) */
+        double gain = (double)inst->retire_thresh / inst->output_level / 6.0;
+        floor = (int32_t)((log2(gain) - 10.0) * (1 << 24));
+        if (floor < 0) floor = 0;
+    }
+
+    int blocks = 0;
+    for (int v = 0; v < MAX_VOICES; v++) {
+        if (inst->voice_retired[v]) continue;
+        if (inst->voice_note[v] < 0 && !inst->voices[v]->isPlaying()) continue;
+        int b = inst->voices[v]->releaseBlocks(floor);
+        if (b < 0) return -1;
+        if (b > blocks) blocks = b;
+    }
+    /* One more block for the fade-out or the last samples, plus the carry */
+    int carry = inst->render_pos < N ? N - inst->render_pos : 0;
+    return (blocks + 1) * N + carry;
+}
+
 /* v2: Initialize default patch */
 static void v2_init_default_patch(dx7_instance_t *inst) {
     memset(inst->current_patch, 0, DX7_PATCH_SIZE);
@@ -392,6 +548,17 @@ static void scan_syx_banks(dx7_instance_t *inst) {
             plugin_log("syx bank list full, skipping extras");
             break;
         }
+        if (inst->syx_bank_count >= inst->syx_bank_capacity) {
+            int cap = inst->syx_bank_capacity ? inst->syx_bank_capacity * 2 : 64;
+            if (cap > MAX_SYX_BANKS) cap = MAX_SYX_BANKS;
+            syx_bank_entry_t *banks = (syx_bank_entry_t *)realloc(inst->syx_banks, cap * sizeof(syx_bank_entry_t));
+            if (!banks) {
+                plugin_log("Out of memory for syx bank list");
+                break;
+            }
+            inst->syx_banks = banks;
+            inst->syx_bank_capacity = cap;
+        }
 
         syx_bank_entry_t *bank = &inst->syx_banks[inst->syx_bank_count++];
         snprintf(bank->path, sizeof(bank->path), "%s/%s", dir_path, entry->d_name);
@@ -413,6 +580,7 @@ static void scan_syx_banks(dx7_instance_t *inst) {
 
 /* Switch to a specific bank by index */
 static void set_syx_bank_index(dx7_instance_t *inst, int index);
+static int json_get_number(const char *json, const char *key, float *out);
 
 /* Extract DX7 parameters from current patch to instance fields */
 static void extract_patch_params(dx7_instance_t *inst) {
@@ -488,6 +656,9 @@ static void extract_patch_params(dx7_instance_t *inst) {
 
 /* Apply instance parameter fields back to current patch and refresh LFO */
 static void apply_patch_params(dx7_instance_t *inst) {
+    uint64_t t0 = perf_now_ns();
+    inst->patch_edited = true;
+
     /* Apply global params */
     inst->current_patch[134] = inst->algorithm;
     inst->current_patch[135] = inst->feedback;
@@ -545,12 +716,15 @@ static void apply_patch_params(dx7_instance_t *inst) {
     inst->lfo.reset(inst->current_patch + 137);
 
     /* Update all active voices with new patch parameters */
+    int updated = 0;
     for (int i = 0; i < MAX_VOICES; i++) {
         if (inst->voice_note[i] >= 0 && inst->voices[i]) {
             inst->voices[i]->update(inst->current_patch, inst->voice_note[i],
                                     inst->voice_velocity[i], 0);
+            updated++;
         }
     }
+    trace_ring_record(&inst->trace, TRACE_PATCH_PARAMS, updated, (int32_t)(perf_now_ns() - t0));
 }
 
 /* v2: Select preset by index */
@@ -559,11 +733,14 @@ static void v2_select_preset(dx7_instance_t *inst, int index) {
     if (index >= inst->preset_count) index = 0;
 
     inst->current_preset = index;
+    trace_ring_record(&inst->trace, TRACE_PRESET, index, 0);
     memcpy(inst->current_patch, inst->patches[index], DX7_PATCH_SIZE);
     strncpy(inst->patch_name, inst->patch_names[index], sizeof(inst->patch_name) - 1);
 
     /* Extract parameters for editing */
     extract_patch_params(inst);
+    inst->patch_edited = false;
+    inst->init_patch = false;
 
     /* Update LFO for new patch */
     inst->lfo.reset(inst->current_patch + 137);
@@ -582,7 +759,10 @@ static void set_syx_bank_index(dx7_instance_t *inst, int index) {
     if (index >= inst->syx_bank_count) index = 0;
 
     inst->syx_bank_index = index;
+    inst->bank_loaded = true;
+    uint64_t t0 = perf_now_ns();
     v2_load_syx(inst, inst->syx_banks[index].path);
+    trace_ring_record(&inst->trace, TRACE_BANK_LOAD, index, (int32_t)(perf_now_ns() - t0));
     inst->current_preset = 0;  /* Reset to first patch in new bank */
     v2_select_preset(inst, 0);
 
@@ -591,32 +771,126 @@ static void set_syx_bank_index(dx7_instance_t *inst, int index) {
     plugin_log(msg);
 }
 
-/* v2: Allocate a voice using voice stealing */
-static int v2_allocate_voice(dx7_instance_t *inst) {
-    /* First try to find a free voice */
+/* Mark every voice free; voice 0 is handed out first */
+static void voice_lists_reset(dx7_instance_t *inst) {
     for (int i = 0; i < MAX_VOICES; i++) {
-        if (inst->voice_note[i] < 0) {
-            return i;
-        }
+        inst->free_voices[i] = MAX_VOICES - 1 - i;
+        inst->voice_note[i] = -1;
+    }
+    inst->free_count = MAX_VOICES;
+    inst->lru_head = -1;
+    inst->lru_tail = -1;
+    for (int n = 0; n < 128; n++) {
+        inst->note_head[n] = -1;
     }
+}
 
-    /* No free voice, steal the oldest one */
-    int oldest = 0;
-    int oldest_age = inst->voice_age[0];
-    for (int i = 1; i < MAX_VOICES; i++) {
-        if (inst->voice_age[i] < oldest_age) {
-            oldest = i;
-            oldest_age = inst->voice_age[i];
-        }
+/* Take a held voice off the LRU list and its note chain (voice_note is kept) */
+static void voice_unlink(dx7_instance_t *inst, int v) {
+    int prev = inst->lru_prev[v], next = inst->lru_next[v];
+    if (prev >= 0) inst->lru_next[prev] = next; else inst->lru_head = next;
+    if (next >= 0) inst->lru_prev[next] = prev; else inst->lru_tail = prev;
+
+    prev = inst->note_prev[v];
+    next = inst->note_next[v];
+    if (prev >= 0) inst->note_next[prev] = next; else inst->note_head[inst->voice_note[v]] = next;
+    if (next >= 0) inst->note_prev[next] = prev;
+}
+
+/* Hold a voice for a note: newest on the LRU list, first on the note chain */
+static void voice_link(dx7_instance_t *inst, int v, int note) {
+    inst->voice_note[v] = note;
+
+    inst->lru_prev[v] = inst->lru_tail;
+    inst->lru_next[v] = -1;
+    if (inst->lru_tail >= 0) inst->lru_next[inst->lru_tail] = v; else inst->lru_head = v;
+    inst->lru_tail = v;
+
+    inst->note_prev[v] = -1;
+    inst->note_next[v] = inst->note_head[note];
+    if (inst->note_head[note] >= 0) inst->note_prev[inst->note_head[note]] = v;
+    inst->note_head[note] = v;
+}
+
+/* Return a held voice to the free stack */
+static void voice_free(dx7_instance_t *inst, int v) {
+    if (inst->voice_note[v] < 0) return;
+    voice_unlink(inst, v);
+    inst->voice_note[v] = -1;
+    inst->voice_sustained[v] = false;
+    inst->free_voices[inst->free_count++] = v;
+}
+
+/* v2: Allocate a voice using voice stealing */
+static int v2_allocate_voice(dx7_instance_t *inst) {
+    /* First try a free voice */
+    if (inst->free_count > 0) {
+        return inst->free_voices[--inst->free_count];
     }
 
+    /* No free voice, steal the oldest one. It stays in voice_note until the
+     * caller relinks it, so the steal can still be traced. */
+    int oldest = inst->lru_head;
+    voice_unlink(inst, oldest);
+
     /* Voice already exists (was allocated at create_instance), just reuse */
     return oldest;
 }
 
-/* v2: Create instance */
+/* Scan banks/ for .syx files (deferred in fast-start mode) */
+static void ensure_banks_scanned(dx7_instance_t *inst) {
+    if (inst->banks_scanned) return;
+    inst->banks_scanned = true;
+
+    uint64_t t0 = perf_now_ns();
+    scan_syx_banks(inst);
+    inst->create_ns[CREATE_SCAN] = perf_now_ns() - t0;
+}
+
+/* Load the first bank, or legacy patches.syx, and select its first preset
+ * unless the patch playing has been edited meanwhile */
+static void ensure_bank_loaded(dx7_instance_t *inst) {
+    ensure_banks_scanned(inst);
+    if (inst->bank_loaded) return;
+    inst->bank_loaded = true;
+
+    uint64_t t0 = perf_now_ns();
+    int syx_result = -1;
+    if (inst->syx_bank_count > 0) {
+        /* Banks found - load the first one */
+        inst->syx_bank_index = 0;
+        syx_result = v2_load_syx(inst, inst->syx_banks[0].path);
+        if (syx_result != 0) {
+            snprintf(inst->load_error, sizeof(inst->load_error),
+                     "Failed to load bank: %s", inst->syx_banks[0].name);
+        }
+    } else {
+        /* No banks found - try legacy patches.syx in module dir */
+        char default_syx[512];
+        snprintf(default_syx, sizeof(default_syx), "%s/patches.syx", inst->module_dir);
+        syx_result = v2_load_syx(inst, default_syx);
+        if (syx_result != 0) {
+            snprintf(inst->load_error, sizeof(inst->load_error),
+                     "No .syx banks found in banks/ folder");
+        }
+    }
+
+    /* Select first preset if we have patches */
+    if (inst->preset_count > 0 && !inst->patch_edited) {
+        v2_select_preset(inst, 0);
+    }
+
+    /* Extract initial patch parameters */
+    extract_patch_params(inst);
+    inst->create_ns[CREATE_LOAD] = perf_now_ns() - t0;
+}
+
+/* v2: Create instance. json_defaults may hold "fast_start":1, which skips the
+ * bank scan and load here; the instance plays the init patch until the first
+ * set_param/get_param that needs a bank. */
 static void* v2_create_instance(const char *module_dir, const char *json_defaults) {
-    (void)json_defaults;
+    uint64_t create_t0 = perf_now_ns();
+    uint64_t t0 = create_t0;
 
     dx7_instance_t *inst = new dx7_instance_t();
     if (!inst) {
@@ -630,14 +904,14 @@ static void* v2_create_instance(const char *module_dir, const char *json_default
     inst->octave_transpose = 0;
     inst->active_voices = 0;
     inst->output_level = 50;
-    inst->age_counter = 0;
     inst->sustain_pedal = false;
     strncpy(inst->patch_name, "Init", sizeof(inst->patch_name) - 1);
 
     /* Initialize bank management */
     inst->syx_bank_count = 0;
     inst->syx_bank_index = 0;
-    memset(inst->syx_banks, 0, sizeof(inst->syx_banks));
+    inst->syx_banks = NULL;
+    inst->syx_bank_capacity = 0;
 
     /* Initialize DX7 parameters to defaults */
     inst->algorithm = 0;
@@ -728,23 +1002,73 @@ static void* v2_create_instance(const char *module_dir, const char *json_default
 
     inst->controllers.refresh();
 
-    /* Initialize tables (global - safe to call multiple times) */
-    Exp2::init();
-    Sin::init();
-    Lfo::init(MOVE_SAMPLE_RATE);
-    Freqlut::init(MOVE_SAMPLE_RATE);
-    PitchEnv::init(MOVE_SAMPLE_RATE);
-    Env::init_sr(MOVE_SAMPLE_RATE);
-    Porta::init_sr(MOVE_SAMPLE_RATE);
+    /* Perf timing starts disabled; the wrapper forwards to the real core */
+    inst->perf_enabled = false;
+    inst->perf_reset_pending = false;
+    inst->perf_core.inner = &inst->fm_core;
+    inst->perf_core.stage = &inst->perf[PERF_FM_RENDER];
+    for (int i = 0; i < PERF_STAGE_COUNT; i++) {
+        perf_stage_reset(&inst->perf[i]);
+    }
+
+    /* Deadline histogram is always on; over = blocks above 100% of budget */
+    perf_hist_reset(&inst->render_hist);
+    inst->render_threshold_pct = 100;
+    inst->render_hist_reset_pending = false;
+
+    /* Tracing is off until set_param("trace", "1") */
+    inst->trace.enabled.store(false);
+    inst->trace.next.store(0);
+
+    /* Only changes anything when the kernels are built with SIMD */
+    inst->voice_batch = true;
+
+    /* Nothing rendered yet */
+    inst->render_pos = N;
+    inst->idle = true;
+    inst->idle_frames = 0;
+    inst->out_gain_from = 0;
+    inst->out_gain_to = -1;
+    inst->out_ramp_pos = N;
+    inst->stream_pos = 0;
+    inst->event_time = -1;
+    inst->block_wall_ns = 0;
+    inst->block_wall_pos = 0;
+    memset(&inst->latency_timed, 0, sizeof(latency_stats_t));
+    memset(&inst->latency_midi, 0, sizeof(latency_stats_t));
+    inst->latency_reset_pending = false;
+
+    /* -96 dBFS is below the int16 output's last bit */
+    set_retire_floor(inst, -96);
+    inst->retired_voices = 0;
+    inst->retire_saved_blocks = 0;
+    inst->retire_reset_pending = false;
+
+    inst->float_engine = false;
+
+    float fval;
+    inst->fast_start = json_defaults && json_get_number(json_defaults, "fast_start", &fval) == 0 && fval != 0;
+    inst->banks_scanned = false;
+    inst->bank_loaded = false;
+    inst->patch_edited = false;
+    inst->init_patch = true;
+    memset(inst->create_ns, 0, sizeof(inst->create_ns));
+    inst->create_ns[CREATE_ALLOC] = perf_now_ns() - t0;
+    t0 = perf_now_ns();
+
+    /* Initialize tables (global, built by the first instance in the process) */
+    init_tables();
+    inst->create_ns[CREATE_TABLES] = perf_now_ns() - t0;
+    t0 = perf_now_ns();
 
     /* Initialize voices */
     for (int i = 0; i < MAX_VOICES; i++) {
         inst->voices[i] = new Dx7Note(inst->tuning, nullptr);
-        inst->voice_note[i] = -1;
         inst->voice_velocity[i] = 0;
-        inst->voice_age[i] = 0;
         inst->voice_sustained[i] = false;
+        inst->voice_retired[i] = false;
     }
+    voice_lists_reset(inst);
 
     /* Initialize default patch */
     v2_init_default_patch(inst);
@@ -756,40 +1080,15 @@ static void* v2_create_instance(const char *module_dir, const char *json_default
 
     /* Initialize load error */
     inst->load_error[0] = '\0';
+    inst->create_ns[CREATE_VOICES] = perf_now_ns() - t0;
 
-    /* Scan for .syx banks in banks/ directory */
-    scan_syx_banks(inst);
-
-    /* Load patches */
-    int syx_result = -1;
-    if (inst->syx_bank_count > 0) {
-        /* Banks found - load the first one */
-        inst->syx_bank_index = 0;
-        syx_result = v2_load_syx(inst, inst->syx_banks[0].path);
-        if (syx_result != 0) {
-            snprintf(inst->load_error, sizeof(inst->load_error),
-                     "Failed to load bank: %s", inst->syx_banks[0].name);
-        }
-    } else {
-        /* No banks found - try legacy patches.syx in module dir */
-        char default_syx[512];
-        snprintf(default_syx, sizeof(default_syx), "%s/patches.syx", module_dir);
-        syx_result = v2_load_syx(inst, default_syx);
-        if (syx_result != 0) {
-            snprintf(inst->load_error, sizeof(inst->load_error),
-                     "No .syx banks found in banks/ folder");
-        }
+    /* Scan for .syx banks in banks/ directory and load the first */
+    if (!inst->fast_start) {
+        ensure_bank_loaded(inst);
     }
 
-    /* Select first preset if we have patches */
-    if (inst->preset_count > 0) {
-        v2_select_preset(inst, 0);
-    }
-
-    /* Extract initial patch parameters */
-    extract_patch_params(inst);
-
-    plugin_log("Instance created");
+    inst->create_ns[CREATE_TOTAL] = perf_now_ns() - create_t0;
+    plugin_log(inst->fast_start ? "Instance created (fast start)" : "Instance created");
     return inst;
 }
 
@@ -806,11 +1105,39 @@ static void v2_destroy_instance(void *instance) {
         }
     }
 
+    free(inst->syx_banks);
+
     plugin_log("Instance destroyed");
     delete inst;
 }
 
 /* v2: MIDI handler */
+/* A note-on is heard from the start of the next engine block. Timed events
+ * are due at their own frame. An on_midi event arrives between render calls;
+ * taking the host to call render_block once per host block in real time, it
+ * was due as far into the last block as the wall-clock time since that call
+ * began, so these show the host-block quantization (up to a block late). */
+static void record_note_latency(dx7_instance_t *inst) {
+    latency_stats_t *s = &inst->latency_timed;
+    uint64_t due = inst->stream_pos;
+    if (inst->event_time >= 0) {
+        due = (uint64_t)inst->event_time;
+    } else {
+        s = &inst->latency_midi;
+        if (inst->block_wall_ns) {
+            uint64_t into = (perf_now_ns() - inst->block_wall_ns) * MOVE_SAMPLE_RATE / 1000000000ull;
+            if (inst->block_wall_pos + into < due) due = inst->block_wall_pos + into;
+        }
+    }
+    uint64_t first = inst->stream_pos + (inst->render_pos < N ? N - inst->render_pos : 0);
+    int delay = first > due ? (int)(first - due) : 0;
+
+    s->notes++;
+    s->sum += delay;
+    if (delay > s->max) s->max = delay;
+    s->last = delay;
+}
+
 static void v2_on_midi(void *instance, const uint8_t *msg, int len, int source) {
     dx7_instance_t *inst = (dx7_instance_t*)instance;
     if (!inst || len < 1) return;
@@ -829,17 +1156,29 @@ static void v2_on_midi(void *instance, const uint8_t *msg, int len, int source)
                 if (note > 127) note = 127;
 
                 /* Count active voices before adding */
-                int active_before = 0;
-                for (int i = 0; i < MAX_VOICES; i++) {
-                    if (inst->voice_note[i] >= 0) active_before++;
-                }
+                int active_before = MAX_VOICES - inst->free_count;
 
                 int voice = v2_allocate_voice(inst);
+                bool stolen = inst->voice_note[voice] >= 0 || inst->voices[voice]->isPlaying();
+                if (stolen) {
+                    trace_ring_record(&inst->trace, TRACE_VOICE_STEAL, voice, inst->voice_note[voice]);
+                }
+                trace_ring_record(&inst->trace, TRACE_NOTE_ON, note, voice);
+                record_note_latency(inst);
+                memset(&inst->voice_stats[voice], 0, sizeof(voice_stats_t));
+                inst->voice_stats[voice].stolen = stolen;
                 inst->voices[voice]->init(inst->current_patch, note, data2, 0, &inst->controllers);
-                inst->voice_note[voice] = note;
+                voice_link(inst, voice, note);
                 inst->voice_velocity[voice] = data2;
-                inst->voice_age[voice] = inst->age_counter++;
                 inst->voice_sustained[voice] = false;
+                inst->voice_retired[voice] = false;
+
+                /* Leave the idle fast path; the LFO runs on from where it would be */
+                if (inst->idle) {
+                    inst->lfo.skip((uint32_t)(inst->idle_frames >> LG_N));
+                    inst->idle_frames &= N - 1;
+                    inst->idle = false;
+                }
 
                 /* Only trigger LFO sync on first voice */
                 if (active_before == 0) {
@@ -851,13 +1190,12 @@ static void v2_on_midi(void *instance, const uint8_t *msg, int len, int source)
                 if (note < 0) note = 0;
                 if (note > 127) note = 127;
 
-                for (int i = 0; i < MAX_VOICES; i++) {
-                    if (inst->voice_note[i] == note) {
-                        if (inst->sustain_pedal) {
-                            inst->voice_sustained[i] = true;
-                        } else if (inst->voices[i]) {
-                            inst->voices[i]->keyup();
-                        }
+                trace_ring_record(&inst->trace, TRACE_NOTE_OFF, note, inst->sustain_pedal ? 1 : 0);
+                for (int i = inst->note_head[note]; i >= 0; i = inst->note_next[i]) {
+                    if (inst->sustain_pedal) {
+                        inst->voice_sustained[i] = true;
+                    } else if (inst->voices[i]) {
+                        inst->voices[i]->keyup();
                     }
                 }
             }
@@ -869,13 +1207,12 @@ static void v2_on_midi(void *instance, const uint8_t *msg, int len, int source)
                 if (note < 0) note = 0;
                 if (note > 127) note = 127;
 
-                for (int i = 0; i < MAX_VOICES; i++) {
-                    if (inst->voice_note[i] == note) {
-                        if (inst->sustain_pedal) {
-                            inst->voice_sustained[i] = true;
-                        } else if (inst->voices[i]) {
-                            inst->voices[i]->keyup();
-                        }
+                trace_ring_record(&inst->trace, TRACE_NOTE_OFF, note, inst->sustain_pedal ? 1 : 0);
+                for (int i = inst->note_head[note]; i >= 0; i = inst->note_next[i]) {
+                    if (inst->sustain_pedal) {
+                        inst->voice_sustained[i] = true;
+                    } else if (inst->voices[i]) {
+                        inst->voices[i]->keyup();
                     }
                 }
             }
@@ -885,21 +1222,24 @@ static void v2_on_midi(void *instance, const uint8_t *msg, int len, int source)
             if (data1 == 64) { /* Sustain pedal */
                 inst->sustain_pedal = (data2 >= 64);
                 if (!inst->sustain_pedal) {
-                    /* Release sustained notes */
-                    for (int i = 0; i < MAX_VOICES; i++) {
+                    /* Release sustained notes (only held voices can be sustained) */
+                    int released = 0;
+                    for (int i = inst->lru_head; i >= 0; i = inst->lru_next[i]) {
                         if (inst->voice_sustained[i] && inst->voices[i]) {
                             inst->voices[i]->keyup();
                             inst->voice_sustained[i] = false;
+                            released++;
                         }
                     }
+                    trace_ring_record(&inst->trace, TRACE_SUSTAIN_RELEASE, released, 0);
                 }
             } else if (data1 == 1) { /* Mod wheel */
                 inst->controllers.modwheel_cc = data2;
                 inst->controllers.refresh();  /* Update pitch_mod/amp_mod from new value */
             } else if (data1 == 123) { /* All notes off */
-                for (int i = 0; i < MAX_VOICES; i++) {
-                    inst->voice_note[i] = -1;
-                    inst->voice_sustained[i] = false;
+                trace_ring_record(&inst->trace, TRACE_ALL_NOTES_OFF, 0, 0);
+                while (inst->lru_head >= 0) {
+                    voice_free(inst, inst->lru_head);
                 }
                 inst->active_voices = 0;
             }
@@ -957,11 +1297,55 @@ static int find_bank_by_name(dx7_instance_t *inst, const char *name) {
     return -1;
 }
 
+/* Fast start: the only keys (set or get) that need bank data. Bank switching
+ * and state restore need the list of banks; preset selection and bank or
+ * preset queries need the first bank itself. Every other key (patch edits,
+ * engine settings, panic, diagnostics) works on the init patch and never
+ * touches the disk. */
+enum { BANK_NEED_LIST = 1, BANK_NEED_LOAD };
+
+static const struct {
+    const char *key;
+    int need;
+} bank_keys[] = {
+    { "state",          BANK_NEED_LIST },
+    { "syx_bank_index", BANK_NEED_LIST },
+    { "next_syx_bank",  BANK_NEED_LIST },
+    { "prev_syx_bank",  BANK_NEED_LIST },
+    { "syx_bank_count", BANK_NEED_LIST },
+    { "bank_count",     BANK_NEED_LIST },
+    { "syx_bank_list",  BANK_NEED_LIST },
+    { "preset",         BANK_NEED_LOAD },
+    { "current_preset", BANK_NEED_LOAD },
+    { "current_patch",  BANK_NEED_LOAD },
+    { "preset_count",   BANK_NEED_LOAD },
+    { "total_patches",  BANK_NEED_LOAD },
+    { "patch_in_bank",  BANK_NEED_LOAD },
+    { "preset_name",    BANK_NEED_LOAD },
+    { "patch_name",     BANK_NEED_LOAD },
+    { "name",           BANK_NEED_LOAD },
+    { "bank_name",      BANK_NEED_LOAD },
+    { "syx_bank_name",  BANK_NEED_LOAD },
+    { "load_error",     BANK_NEED_LOAD },
+};
+
+static void ensure_bank_for_key(dx7_instance_t *inst, const char *key) {
+    for (size_t i = 0; i < sizeof(bank_keys) / sizeof(bank_keys[0]); i++) {
+        if (strcmp(key, bank_keys[i].key) == 0) {
+            if (bank_keys[i].need == BANK_NEED_LOAD) ensure_bank_loaded(inst);
+            else ensure_banks_scanned(inst);
+            return;
+        }
+    }
+}
+
 /* v2: Set parameter */
 static void v2_set_param(void *instance, const char *key, const char *val) {
     dx7_instance_t *inst = (dx7_instance_t*)instance;
     if (!inst) return;
 
+    ensure_bank_for_key(inst, key);
+
     /* State restore from patch save */
     if (strcmp(key, "state") == 0) {
         float fval;
@@ -980,6 +1364,8 @@ static void v2_set_param(void *instance, const char *key, const char *val) {
         }
         if (bank_idx >= 0) {
             set_syx_bank_index(inst, bank_idx);
+        } else {
+            ensure_bank_loaded(inst);
         }
 
         /* Restore preset */
@@ -1244,13 +1630,18 @@ static void v2_set_param(void *instance, const char *key, const char *val) {
     }
 
     if (strcmp(key, "syx_path") == 0) {
+        inst->bank_loaded = true;
+        uint64_t t0 = perf_now_ns();
         v2_load_syx(inst, val);
+        trace_ring_record(&inst->trace, TRACE_BANK_LOAD, -1, (int32_t)(perf_now_ns() - t0));
         if (inst->preset_count > 0) {
             v2_select_preset(inst, 0);
         }
     } else if (strcmp(key, "preset") == 0) {
         int idx = atoi(val);
-        if (idx != inst->current_preset) v2_select_preset(inst, idx);
+        /* After a deferred load that kept an edited init patch, current_preset
+         * is 0 without preset 0 playing */
+        if (idx != inst->current_preset || inst->init_patch) v2_select_preset(inst, idx);
     } else if (strcmp(key, "octave_transpose") == 0) {
         int v = atoi(val);
         if (v < -3) v = -3;
@@ -1270,18 +1661,91 @@ static void v2_set_param(void *instance, const char *key, const char *val) {
         if (v > 100) v = 100;
         inst->output_level = v;
     } else if (strcmp(key, "panic") == 0 || strcmp(key, "all_notes_off") == 0) {
+        trace_ring_record(&inst->trace, TRACE_ALL_NOTES_OFF, 0, 0);
         /* Silence all voices */
         for (int i = 0; i < MAX_VOICES; i++) {
             if (inst->voices[i]) {
                 delete inst->voices[i];
                 inst->voices[i] = new Dx7Note(inst->tuning, nullptr);
             }
-            inst->voice_note[i] = -1;
             inst->voice_sustained[i] = false;
-            inst->voice_age[i] = 0;
+            inst->voice_retired[i] = false;
         }
+        voice_lists_reset(inst);
         inst->sustain_pedal = false;
         inst->active_voices = 0;
+        /* Drop what is left of the last engine block */
+        inst->render_pos = N;
+    }
+    /* Render timing: "1" enables, "0" disables, "reset" clears the counters */
+    else if (strcmp(key, "perf_stats") == 0) {
+        if (strcmp(val, "reset") == 0) {
+            inst->perf_reset_pending = true;
+        } else {
+            bool enable = atoi(val) != 0;
+            if (enable && !inst->perf_enabled) inst->perf_reset_pending = true;
+            inst->perf_enabled = enable;
+            route_core(inst);
+        }
+    }
+    /* Deadline histogram: "reset" clears it */
+    else if (strcmp(key, "render_time") == 0) {
+        if (strcmp(val, "reset") == 0) inst->render_hist_reset_pending = true;
+    }
+    /* Percent of the block budget above which a block counts as over */
+    else if (strcmp(key, "render_time_threshold") == 0) {
+        int v = atoi(val);
+        if (v < 1) v = 1;
+        if (v > 1000) v = 1000;
+        inst->render_threshold_pct = v;
+    }
+    /* Voice-parallel feedback operators, on by default; "0" for comparison */
+    else if (strcmp(key, "voice_batch") == 0) {
+        inst->voice_batch = atoi(val) != 0;
+    }
+    /* Release tails retire below this many dBFS, "0" keeps every tail */
+    else if (strcmp(key, "retire_floor") == 0) {
+        set_retire_floor(inst, atoi(val));
+    }
+    /* "reset" clears the retire_stats counters */
+    else if (strcmp(key, "retire_stats") == 0) {
+        if (strcmp(val, "reset") == 0) inst->retire_reset_pending = true;
+    }
+    /* "reset" clears the midi_latency counters */
+    else if (strcmp(key, "midi_latency") == 0) {
+        if (strcmp(val, "reset") == 0) inst->latency_reset_pending = true;
+    }
+    /* Render engine: "q24" (default) or "float" */
+    else if (strcmp(key, "engine") == 0) {
+        inst->float_engine = strcmp(val, "float") == 0;
+        route_core(inst);
+    }
+    /* Operator sine source of the Q24 core, "table" or "poly", default per
+     * build (see fm_core.h) */
+    else if (strcmp(key, "sine") == 0) {
+        inst->fm_core.setSinePoly(strcmp(val, "poly") == 0);
+    }
+    /* Unmodulated operators of the Q24 core: "sine" (default), "resonator"
+     * or "diff" recurrence */
+    else if (strcmp(key, "pure_kernel") == 0) {
+        FmOpKernel::PureKernel k = FmOpKernel::PURE_SINE;
+        if (strcmp(val, "resonator") == 0) k = FmOpKernel::PURE_RESONATOR;
+        else if (strcmp(val, "diff") == 0) k = FmOpKernel::PURE_DIFF;
+        inst->fm_core.setPureKernel(k);
+    }
+    /* Event trace: "1"/"0" records or stops, trace_dump writes it to a file */
+    else if (strcmp(key, "trace") == 0) {
+        inst->trace.enabled.store(atoi(val) != 0);
+    }
+    else if (strcmp(key, "trace_dump") == 0) {
+        char msg[320];
+        int n = trace_ring_dump(&inst->trace, val);
+        if (n < 0) {
+            snprintf(msg, sizeof(msg), "Cannot write trace: %s", val);
+        } else {
+            snprintf(msg, sizeof(msg), "Wrote %d trace events to %s", n, val);
+        }
+        plugin_log(msg);
     }
     /* Bank switching */
     else if (strcmp(key, "syx_bank_index") == 0) {
@@ -1579,6 +2043,19 @@ static int v2_get_param(void *instance, const char *key, char *buf, int buf_len)
     dx7_instance_t *inst = (dx7_instance_t*)instance;
     if (!inst) return -1;
 
+    /* Creation phase times in ns; scan/load are filled in when a deferred load runs */
+    if (strcmp(key, "create_time") == 0) {
+        int w = snprintf(buf, buf_len, "{\"fast_start\":%d,\"pending\":%d",
+                         inst->fast_start ? 1 : 0, inst->bank_loaded ? 0 : 1);
+        for (int i = 0; i < CREATE_PHASE_COUNT && w < buf_len; i++) {
+            w += snprintf(buf + w, buf_len - w, ",\"%s\":%llu", create_phase_names[i],
+                          (unsigned long long)inst->create_ns[i]);
+        }
+        if (w < buf_len) w += snprintf(buf + w, buf_len - w, "}");
+        return w < buf_len ? w : -1;
+    }
+    ensure_bank_for_key(inst, key);
+
     if (strcmp(key, "load_error") == 0) {
         if (inst->load_error[0]) {
             return snprintf(buf, buf_len, "%s", inst->load_error);
@@ -1600,9 +2077,111 @@ static int v2_get_param(void *instance, const char *key, char *buf, int buf_len)
     if (strcmp(key, "active_voices") == 0) {
         return snprintf(buf, buf_len, "%d", inst->active_voices);
     }
+    /* For the chain host: 1 while render_block only produces silence (until
+     * the next note-on), and the frames until that happens (-1 = held) */
+    if (strcmp(key, "is_silent") == 0) {
+        return snprintf(buf, buf_len, "%d", inst->idle ? 1 : 0);
+    }
+    if (strcmp(key, "tail") == 0) {
+        return snprintf(buf, buf_len, "%d", tail_frames(inst));
+    }
     if (strcmp(key, "polyphony") == 0) {
         return snprintf(buf, buf_len, "%d", MAX_VOICES);
     }
+    /* Per-stage render timing in ns: {"enabled":1,"lfo":{"n":..,"min":..,"avg":..,"max":..},...} */
+    if (strcmp(key, "perf_stats") == 0) {
+        int w = snprintf(buf, buf_len, "{\"enabled\":%d", inst->perf_enabled ? 1 : 0);
+        for (int i = 0; i < PERF_STAGE_COUNT && w < buf_len; i++) {
+            w += snprintf(buf + w, buf_len - w, ",\"%s\":", perf_stage_names[i]);
+            if (w >= buf_len) break;
+            w += perf_stage_json(&inst->perf[i], buf + w, buf_len - w);
+        }
+        if (w < buf_len) w += snprintf(buf + w, buf_len - w, "}");
+        return w < buf_len ? w : -1;
+    }
+    /* Sounding voices: {"voices":[{"v":..,"note":..,"env":"<stage per op>",...}]}
+     * env digits are op1..op6 envelope stages (3 = release, 4 = finished) */
+    if (strcmp(key, "voice_stats") == 0) {
+        int w = snprintf(buf, buf_len, "{\"voices\":[");
+        bool first = true;
+        for (int v = 0; v < MAX_VOICES && w < buf_len; v++) {
+            if (inst->voice_note[v] < 0 && !inst->voices[v]->isPlaying()) continue;
+            const voice_stats_t *vs = &inst->voice_stats[v];
+            VoiceStatus status;
+            inst->voices[v]->peekVoiceStatus(status);
+            char env[7];
+            for (int op = 0; op < 6; op++) env[op] = '0' + status.ampStep[op];
+            env[6] = '\0';
+            w += snprintf(buf + w, buf_len - w,
+                "%s{\"v\":%d,\"note\":%d,\"sus\":%d,\"stolen\":%d,\"env\":\"%s\","
+                "\"ops\":%d,\"rendered\":%llu,\"skipped\":%llu,\"blocks\":%llu,\"ns\":%llu}",
+                first ? "" : ",", v, inst->voice_note[v],
+                inst->voice_sustained[v] ? 1 : 0, vs->stolen ? 1 : 0, env, vs->last_ops,
+                (unsigned long long)vs->ops_rendered, (unsigned long long)vs->ops_skipped,
+                (unsigned long long)vs->blocks, (unsigned long long)vs->render_ns);
+            first = false;
+        }
+        if (w < buf_len) w += snprintf(buf + w, buf_len - w, "]}");
+        return w < buf_len ? w : -1;
+    }
+    /* Block render time vs. each block's budget; percentiles are bucket upper
+     * edges, converted to ns with the mean budget of the recorded blocks */
+    if (strcmp(key, "render_time") == 0) {
+        const perf_hist_t *h = &inst->render_hist;
+        const double budget_ns = perf_hist_budget_ns(h);
+        uint32_t p50 = perf_hist_percentile(h, 50);
+        uint32_t p99 = perf_hist_percentile(h, 99);
+        return snprintf(buf, buf_len,
+            "{\"blocks\":%llu,\"budget_ns\":%.0f,"
+            "\"p50_ns\":%.0f,\"p99_ns\":%.0f,\"max_ns\":%llu,"
+            "\"p50_pct\":%.1f,\"p99_pct\":%.1f,\"max_pct\":%.1f,"
+            "\"threshold_pct\":%d,\"over\":%llu}",
+            (unsigned long long)h->count, budget_ns,
+            budget_ns * p50 / 1000, budget_ns * p99 / 1000, (unsigned long long)h->max_ns,
+            p50 / 10.0, p99 / 10.0, h->max_permille / 10.0,
+            inst->render_threshold_pct, (unsigned long long)h->over);
+    }
+    if (strcmp(key, "render_time_threshold") == 0) {
+        return snprintf(buf, buf_len, "%d", inst->render_threshold_pct);
+    }
+    if (strcmp(key, "trace") == 0) {
+        return snprintf(buf, buf_len, "%d", inst->trace.enabled.load() ? 1 : 0);
+    }
+    if (strcmp(key, "voice_batch") == 0) {
+        return snprintf(buf, buf_len, "%d", inst->voice_batch ? 1 : 0);
+    }
+    if (strcmp(key, "retire_floor") == 0) {
+        return snprintf(buf, buf_len, "%d", inst->retire_floor_db);
+    }
+    /* Early retirement: voices retired and N-sample voice-blocks not rendered
+     * because of it (counted until the tail would have ended on its own) */
+    if (strcmp(key, "retire_stats") == 0) {
+        return snprintf(buf, buf_len, "{\"floor_db\":%d,\"retired\":%llu,\"saved_blocks\":%llu}",
+                        inst->retire_floor_db, (unsigned long long)inst->retired_voices,
+                        (unsigned long long)inst->retire_saved_blocks);
+    }
+    /* Note-on to first rendered sample, in frames, per delivery path */
+    if (strcmp(key, "midi_latency") == 0) {
+        const latency_stats_t *t = &inst->latency_timed;
+        const latency_stats_t *m = &inst->latency_midi;
+        return snprintf(buf, buf_len,
+                        "{\"timed\":{\"notes\":%llu,\"mean\":%.1f,\"max\":%d,\"last\":%d},"
+                        "\"on_midi\":{\"notes\":%llu,\"mean\":%.1f,\"max\":%d,\"last\":%d}}",
+                        (unsigned long long)t->notes, t->notes ? (double)t->sum / t->notes : 0.0,
+                        t->max, t->last,
+                        (unsigned long long)m->notes, m->notes ? (double)m->sum / m->notes : 0.0,
+                        m->max, m->last);
+    }
+    if (strcmp(key, "engine") == 0) {
+        return snprintf(buf, buf_len, "%s", inst->float_engine ? "float" : "q24");
+    }
+    if (strcmp(key, "sine") == 0) {
+        return snprintf(buf, buf_len, "%s", inst->fm_core.sinePoly() ? "poly" : "table");
+    }
+    if (strcmp(key, "pure_kernel") == 0) {
+        static const char *names[] = { "sine", "resonator", "diff" };
+        return snprintf(buf, buf_len, "%s", names[inst->fm_core.pureKernel()]);
+    }
     /* Unified bank/preset parameters for Chain compatibility */
     if (strcmp(key, "bank_name") == 0) {
         /* Bank = syx filename (extract basename from patch_path) */
@@ -2279,66 +2858,322 @@ static int v2_get_error(void *instance, char *buf, int buf_len) {
     return len;
 }
 
-/* v2: Render block */
-static void v2_render_block(void *instance, int16_t *out, int frames) {
-    dx7_instance_t *inst = (dx7_instance_t*)instance;
-    if (!inst) {
-        memset(out, 0, frames * 2 * sizeof(int16_t));
+/* Render the next N engine samples into render_buffer */
+static void render_engine_block(dx7_instance_t *inst, bool perf) {
+    uint64_t t0 = 0;
+
+    /* Still silent from the block that went idle */
+    if (inst->idle) {
+        inst->idle_frames += N;
         return;
     }
 
-    /* Clear output */
-    memset(out, 0, frames * 2 * sizeof(int16_t));
+    /* Get LFO values */
+    if (perf) t0 = perf_now_ns();
+    int32_t lfo_val = inst->lfo.getsample();
+    int32_t lfo_delay = inst->lfo.getdelay();
+    if (perf) perf_stage_add(&inst->perf[PERF_LFO], perf_now_ns() - t0);
+
+    /* Voices sounding this block; a release tail under the retire
+     * floor renders one last block, faded out, and then stops */
+    int sounding[MAX_VOICES];
+    bool retiring[MAX_VOICES];
+    uint64_t voice_ns[MAX_VOICES];
+    int count = 0;
+    for (int v = 0; v < MAX_VOICES; v++) {
+        if (inst->voice_retired[v]) {
+            if (inst->voices[v]->retiredTick()) {
+                inst->retire_saved_blocks++;
+            } else {
+                inst->voice_retired[v] = false;
+            }
+        } else if (inst->voice_note[v] >= 0 || inst->voices[v]->isPlaying()) {
+            voice_ns[count] = 0;
+            retiring[count] = tail_inaudible(inst, v);
+            sounding[count++] = v;
+        }
+    }
 
-    /* Process in N-sample blocks */
-    int remaining = frames;
-    int out_pos = 0;
+    /* Batch mode: advance every voice first, then compute their
+     * feedback operators together, one voice per SIMD lane */
+    bool batch = inst->voice_batch && count > 1;
+    if (batch) {
+        FmFeedbackLane lanes[MAX_VOICES];
+        for (int k = 0; k < count; k++) {
+            if (perf) t0 = perf_now_ns();
+            inst->voices[sounding[k]]->computeParams(lfo_val, lfo_delay, &inst->controllers);
+            if (perf) voice_ns[k] = perf_now_ns() - t0;
+            inst->voices[sounding[k]]->feedbackLane(&lanes[k]);
+        }
+        if (perf) t0 = perf_now_ns();
+        engine_core(inst)->prepareFeedback(lanes, count);
+        if (perf) perf_stage_add(&inst->perf[PERF_FM_RENDER], perf_now_ns() - t0);
+    }
 
-    while (remaining > 0) {
-        int block_size = (remaining > N) ? N : remaining;
+    /* Render and count active voices. The first voice into render_buffer
+     * overwrites it, so it needs no clearing; a retiring voice overwrites
+     * fade_buffer. */
+    inst->active_voices = 0;
+    bool filled = false;
+    for (int k = 0; k < count; k++) {
+        int v = sounding[k];
+        voice_stats_t *vs = &inst->voice_stats[v];
+        int32_t *dst = retiring[k] ? inst->fade_buffer : inst->render_buffer;
+        bool add = !retiring[k] && filled;
+        if (perf) t0 = perf_now_ns();
+        if (batch) {
+            inst->voices[v]->render(dst, &inst->controllers, add);
+        } else {
+            inst->voices[v]->compute(dst, lfo_val, lfo_delay, &inst->controllers, add);
+        }
+        if (perf) {
+            uint64_t dt = voice_ns[k] + perf_now_ns() - t0;
+            perf_stage_add(&inst->perf[PERF_VOICE], dt);
+            vs->render_ns += dt;
+        }
+        vs->last_ops = engine_core(inst)->renderedOps();
+        vs->ops_rendered += vs->last_ops;
+        vs->ops_skipped += 6 - vs->last_ops;
+        vs->blocks++;
+
+        if (retiring[k]) {
+            for (int i = 0; i < N; i++) {
+                int32_t faded = (int32_t)(((int64_t)dst[i] * (N - i)) >> LG_N);
+                inst->render_buffer[i] = filled ? inst->render_buffer[i] + faded : faded;
+            }
+            trace_ring_record(&inst->trace, TRACE_VOICE_RETIRE, v, inst->voice_note[v]);
+            inst->voices[v]->retire();
+            inst->voice_retired[v] = true;
+            inst->retired_voices++;
+        }
 
-        /* Clear render buffer */
+        if (!inst->voices[v]->isPlaying()) {
+            voice_free(inst, v);  /* Voice finished */
+        } else {
+            inst->active_voices++;
+        }
+        filled = true;
+    }
+
+    /* Nothing sounding: go idle. Retired voices stop ticking, and the
+     * blocks their tails had left count as saved straight away. */
+    if (!filled) {
         memset(inst->render_buffer, 0, sizeof(inst->render_buffer));
+        for (int v = 0; v < MAX_VOICES; v++) {
+            if (!inst->voice_retired[v]) continue;
+            int left = inst->voices[v]->releaseBlocks(-1);
+            if (left > 0) inst->retire_saved_blocks += left;
+            inst->voice_retired[v] = false;
+        }
+        inst->idle = true;
+    }
+}
 
-        /* Get LFO values */
-        int32_t lfo_val = inst->lfo.getsample();
-        int32_t lfo_delay = inst->lfo.getdelay();
+/* Apply a timed event; it is due at frame offset of the block starting at block_start */
+static void apply_timed_event(dx7_instance_t *inst, const dx7_midi_event_t *ev,
+                              uint64_t block_start, int frames) {
+    int offset = ev->offset;
+    if (offset < 0) offset = 0;
+    if (offset > frames) offset = frames;
+    inst->event_time = (int64_t)(block_start + offset);
+    v2_on_midi(inst, ev->msg, ev->len, ev->source);
+    inst->event_time = -1;
+}
 
-        /* Count active voices and render */
-        inst->active_voices = 0;
-        for (int v = 0; v < MAX_VOICES; v++) {
-            if (inst->voice_note[v] >= 0 || inst->voices[v]->isPlaying()) {
-                inst->voices[v]->compute(inst->render_buffer, lfo_val, lfo_delay, &inst->controllers);
+/* Q16 output gain for output_level 0-100 */
+static inline int32_t output_gain(int level) {
+    return (level * 65536 + 50) / 100;
+}
 
-                if (!inst->voices[v]->isPlaying()) {
-                    inst->voice_note[v] = -1;  /* Voice finished */
-                } else {
-                    inst->active_voices++;
-                }
-            }
-        }
+/* Output gain for the next frame: start a ramp if output_level moved */
+static void update_output_gain(dx7_instance_t *inst) {
+    int32_t target = output_gain(inst->output_level);
+    if (target == inst->out_gain_to) return;
+    if (inst->out_gain_to < 0) {
+        inst->out_gain_from = target;
+        inst->out_ramp_pos = N;
+    } else {
+        int32_t delta = inst->out_gain_to - inst->out_gain_from;
+        inst->out_gain_from += (delta * inst->out_ramp_pos) >> LG_N;
+        inst->out_ramp_pos = 0;
+    }
+    inst->out_gain_to = target;
+}
 
-        /* Convert to stereo int16 output */
-        for (int i = 0; i < block_size; i++) {
-            int32_t val = inst->render_buffer[i] >> 4;
-            val = (val * inst->output_level) / 100;
+/* Gain for the next ramp frame, advancing the ramp */
+static inline int32_t ramp_gain(dx7_instance_t *inst) {
+    int32_t delta = inst->out_gain_to - inst->out_gain_from;
+    return inst->out_gain_from + ((delta * ++inst->out_ramp_pos) >> LG_N);
+}
 
-            int16_t sample;
-            if (val < -(1 << 24)) {
-                sample = -32768;
-            } else if (val >= (1 << 24)) {
-                sample = 32767;
+/* render_buffer to interleaved int16: full scale is 1 << 28 at gain 65536,
+ * so a sample is (src * gain) >> 29, saturated and written to L and R */
+static inline int16_t output_sample(int32_t src, int32_t gain) {
+    int32_t val = (int32_t)(((int64_t)src * gain) >> 29);
+    if (val < -32768) return -32768;
+    if (val > 32767) return 32767;
+    return (int16_t)val;
+}
+
+static void output_int16(dx7_instance_t *inst, const int32_t *src, int16_t *out, int n) {
+    int i = 0;
+    for (; i < n && inst->out_ramp_pos < N; i++) {
+        out[2 * i] = out[2 * i + 1] = output_sample(src[i], ramp_gain(inst));
+    }
+    int32_t gain = inst->out_gain_to;
+#if SIMD_LANES > 1
+    simd_i32 vgain = simd_set1(gain);
+    for (; i + SIMD_LANES <= n; i += SIMD_LANES) {
+        simd_store_i16_dup(out + 2 * i, simd_mul_shr<29>(simd_load(src + i), vgain));
+    }
+#endif
+    for (; i < n; i++) {
+        out[2 * i] = out[2 * i + 1] = output_sample(src[i], gain);
+    }
+}
+
+/* render_buffer to float, 1.0 = int16 full scale; out_r may be NULL */
+static void output_float(dx7_instance_t *inst, const int32_t *src, float *out_l, float *out_r,
+                         int n) {
+    const float q = 1.0f / ((float)(1 << 28) * 65536.0f);
+    int i = 0;
+    for (; i < n && inst->out_ramp_pos < N; i++) {
+        out_l[i] = src[i] * (ramp_gain(inst) * q);
+    }
+    float scale = inst->out_gain_to * q;
+    for (; i < n; i++) {
+        out_l[i] = src[i] * scale;
+    }
+    if (out_r) memcpy(out_r, out_l, n * sizeof(float));
+}
+
+/* Render one host block, applying events (sorted by offset) as it goes.
+ * Output goes to out (interleaved int16) or, when out is NULL, to out_l
+ * and out_r (float, out_r optional). */
+static void render_block_events(void *instance, int16_t *out, float *out_l, float *out_r,
+                                int frames, const dx7_midi_event_t *events, int count) {
+    dx7_instance_t *inst = (dx7_instance_t*)instance;
+    if (!inst) {
+        if (out) memset(out, 0, frames * 2 * sizeof(int16_t));
+        if (out_l) memset(out_l, 0, frames * sizeof(float));
+        if (out_r) memset(out_r, 0, frames * sizeof(float));
+        return;
+    }
+
+    if (inst->perf_reset_pending) {
+        for (int i = 0; i < PERF_STAGE_COUNT; i++) {
+            perf_stage_reset(&inst->perf[i]);
+        }
+        inst->perf_reset_pending = false;
+    }
+    if (inst->render_hist_reset_pending) {
+        perf_hist_reset(&inst->render_hist);
+        inst->render_hist_reset_pending = false;
+    }
+    if (inst->retire_reset_pending) {
+        inst->retired_voices = 0;
+        inst->retire_saved_blocks = 0;
+        inst->retire_reset_pending = false;
+    }
+    if (inst->latency_reset_pending) {
+        memset(&inst->latency_timed, 0, sizeof(latency_stats_t));
+        memset(&inst->latency_midi, 0, sizeof(latency_stats_t));
+        inst->latency_reset_pending = false;
+    }
+    bool perf = inst->perf_enabled;
+    uint64_t block_t0 = perf_now_ns();
+    inst->block_wall_ns = block_t0;
+    inst->block_wall_pos = inst->stream_pos;
+    uint64_t t0 = 0;
+    trace_ring_record(&inst->trace, TRACE_BLOCK_START, frames, 0);
+
+    if (inst->idle && count == 0) {
+        /* Idle fast path: nothing sounding and no events, so the block is
+         * silence (what is left of render_buffer is too) and the engine is
+         * not touched. render_pos and idle_frames move as if the silent
+         * engine blocks had been rendered, keeping the block grid. */
+        if (out) {
+            memset(out, 0, frames * 2 * sizeof(int16_t));
+        } else {
+            memset(out_l, 0, frames * sizeof(float));
+            if (out_r) memset(out_r, 0, frames * sizeof(float));
+        }
+        int rest = frames - (N - inst->render_pos);
+        if (rest <= 0) {
+            inst->render_pos += frames;
+        } else {
+            int blocks = (rest + N - 1) >> LG_N;
+            inst->idle_frames += (uint64_t)blocks << LG_N;
+            inst->render_pos = rest - ((blocks - 1) << LG_N);
+        }
+        inst->stream_pos += frames;
+    } else {
+        /* Engine blocks are N samples. Samples of the last one this call does
+         * not need are kept in render_buffer (from render_pos on) and played
+         * first next time, so any frames value keeps envelopes, LFO and phases
+         * advancing exactly once per N output samples.
+         *
+         * Timed events are quantized to engine block boundaries: each one is
+         * applied just before the first engine block that starts at or after
+         * its offset, so it is up to N - 1 frames late and never early. */
+        uint64_t block_start = inst->stream_pos;
+        int next_event = 0;
+        int out_pos = 0;
+        while (out_pos < frames) {
+            if (inst->render_pos >= N) {
+                while (next_event < count && events[next_event].offset <= out_pos) {
+                    apply_timed_event(inst, &events[next_event++], block_start, frames);
+                }
+                render_engine_block(inst, perf);
+                inst->render_pos = 0;
+            }
+            int chunk = N - inst->render_pos;
+            if (chunk > frames - out_pos) chunk = frames - out_pos;
+
+            if (perf) t0 = perf_now_ns();
+            const int32_t *src = inst->render_buffer + inst->render_pos;
+            update_output_gain(inst);
+            if (out) {
+                output_int16(inst, src, out + 2 * out_pos, chunk);
             } else {
-                sample = (int16_t)(val >> 9);
+                output_float(inst, src, out_l + out_pos, out_r ? out_r + out_pos : NULL, chunk);
             }
+            out_pos += chunk;
+            if (perf) perf_stage_add(&inst->perf[PERF_OUTPUT], perf_now_ns() - t0);
 
-            out[out_pos * 2] = sample;
-            out[out_pos * 2 + 1] = sample;
-            out_pos++;
+            inst->render_pos += chunk;
+            inst->stream_pos += chunk;
         }
 
-        remaining -= block_size;
+        /* The rest start with the engine block the next call renders */
+        while (next_event < count) {
+            apply_timed_event(inst, &events[next_event++], block_start, frames);
+        }
     }
+
+    uint64_t block_ns = perf_now_ns() - block_t0;
+    trace_ring_record(&inst->trace, TRACE_BLOCK_END, inst->active_voices, (int32_t)block_ns);
+    if (perf) perf_stage_add(&inst->perf[PERF_BLOCK], block_ns);
+    perf_hist_add(&inst->render_hist, block_ns,
+                  (uint64_t)frames * 1000000000ull / MOVE_SAMPLE_RATE,
+                  inst->render_threshold_pct);
+}
+
+/* v2: Render block, MIDI already applied through on_midi */
+static void v2_render_block(void *instance, int16_t *out, int frames) {
+    render_block_events(instance, out, NULL, NULL, frames, NULL, 0);
+}
+
+/* Extension entry point, see dx7_midi_event_t */
+extern "C" void dx7_render_block_events(void *instance, int16_t *out_interleaved_lr, int frames,
+                                        const dx7_midi_event_t *events, int count) {
+    render_block_events(instance, out_interleaved_lr, NULL, NULL, frames, events, count);
+}
+
+/* Extension entry point: float32 output */
+extern "C" void dx7_render_block_float(void *instance, float *out_l, float *out_r, int frames,
+                                       const dx7_midi_event_t *events, int count) {
+    render_block_events(instance, NULL, out_l, out_r, frames, events, count);
 }
 
 /* v2 API struct */
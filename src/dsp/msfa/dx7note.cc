@@ -154,14 +154,18 @@ const int32_t Dx7Note::mtsLogFreqToNoteLogFreq = (1 << 24) / log(2.);
 Dx7Note::Dx7Note(std::shared_ptr<TuningState> ts, MTSClient *mtsc)
 : tuning_state_(ts), mtsClient(mtsc) {
     initialised_ = false;
+    retired_ = false;
     for(int op=0;op<6;op++) {
         params_[op].phase = 0;
         params_[op].gain_out = 0;
     }
+    fb_buf_[0] = 0;
+    fb_buf_[1] = 0;
 }
 
 void Dx7Note::init(const uint8_t patch[156], int midinote, int velocity, int channel, const Controllers *ctrls) {
     initialised_ = true;
+    retired_ = false;
     currentPatch = patch;
     int rates[4];
     int levels[4];
@@ -218,7 +222,13 @@ void Dx7Note::initPortamento(const Dx7Note &srcNote) {
     }
 }
 
-void Dx7Note::compute(int32_t *buf, int32_t lfo_val, int32_t lfo_delay, const Controllers *ctrls) {
+void Dx7Note::compute(int32_t *buf, int32_t lfo_val, int32_t lfo_delay, const Controllers *ctrls,
+                      bool add) {
+    computeParams(lfo_val, lfo_delay, ctrls);
+    render(buf, ctrls, add);
+}
+
+void Dx7Note::computeParams(int32_t lfo_val, int32_t lfo_delay, const Controllers *ctrls) {
     // ==== PITCH ====
     uint32_t pmd = pitchmoddepth_ * lfo_delay;  // Q32
     int32_t senslfo = pitchmodsens_ * (lfo_val - (1 << 23));
@@ -333,7 +343,17 @@ void Dx7Note::compute(int32_t *buf, int32_t lfo_val, int32_t lfo_delay, const Co
             params_[op].level_in = level;
         }
     }
-    ctrls->core->render(buf, params_, algorithm_, fb_buf_, fb_shift_);
+}
+
+void Dx7Note::render(int32_t *buf, const Controllers *ctrls, bool add) {
+    ctrls->core->render(buf, params_, algorithm_, fb_buf_, fb_shift_, add);
+}
+
+void Dx7Note::feedbackLane(FmFeedbackLane *lane) {
+    lane->params = params_;
+    lane->algorithm = algorithm_;
+    lane->fb_buf = fb_buf_;
+    lane->fb_shift = fb_shift_;
 }
 
 void Dx7Note::keyup() {
@@ -443,7 +463,7 @@ void Dx7Note::oscSync() {
 // a note is playing if it's been initialised and any carrier's amp
 // envelope is active
 bool Dx7Note::isPlaying() {
-    if ( !initialised_ ) return false;
+    if ( !initialised_ || retired_ ) return false;
     for (int i=0; i<6; i++) {
         if ( FmCore::isCarrier(algorithm_, i) && env_[i].isActive() ) {
             return true;
@@ -451,3 +471,41 @@ bool Dx7Note::isPlaying() {
     }
     return false;
 }
+
+int32_t Dx7Note::releasePeak() {
+    int32_t peak = 0;
+    for (int i=0; i<6; i++) {
+        if ( !FmCore::isCarrier(algorithm_, i) ) continue;
+        int32_t level = env_[i].releasePeak();
+        if ( level == INT32_MAX ) return INT32_MAX;
+        peak += Exp2::lookup(level - (14 * (1 << 24)));
+    }
+    return peak;
+}
+
+int Dx7Note::releaseBlocks(int32_t floor) {
+    if ( !initialised_ ) return 0;
+    int blocks = 0;
+    for (int i=0; i<6; i++) {
+        if ( !FmCore::isCarrier(algorithm_, i) ) continue;
+        int b = env_[i].releaseBlocks(floor);
+        if ( b < 0 ) return -1;
+        if ( b > blocks ) blocks = b;
+    }
+    return blocks;
+}
+
+void Dx7Note::retire() {
+    retired_ = true;
+}
+
+bool Dx7Note::retiredTick() {
+    bool playing = false;
+    for (int i=0; i<6; i++) {
+        if ( FmCore::isCarrier(algorithm_, i) ) {
+            env_[i].getsample();
+            playing = playing || env_[i].isActive();
+        }
+    }
+    return initialised_ && playing;
+}
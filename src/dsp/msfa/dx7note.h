@@ -44,14 +44,36 @@ public:
     void init(const uint8_t patch[156], int midinote, int velocity, int channel, const Controllers *ctrls);
     void initPortamento(const Dx7Note &srcNote);
 
-    // Note: this _adds_ to the buffer. Interesting question whether it's
-    // worth it...
+    // Note: this _adds_ to the buffer, unless add is false; then it
+    // overwrites all N samples, so the first note of a mix needs no clear.
     void compute(int32_t *buf, int32_t lfo_val, int32_t lfo_delay,
-                 const Controllers *ctrls);
+                 const Controllers *ctrls, bool add = true);
+
+    // compute() in two steps, so the feedback operators of several notes can
+    // be batched in between (FmCore::prepareFeedback): computeParams advances
+    // envelopes and pitch, render runs the operators and adds to buf.
+    void computeParams(int32_t lfo_val, int32_t lfo_delay, const Controllers *ctrls);
+    void render(int32_t *buf, const Controllers *ctrls, bool add = true);
+    void feedbackLane(FmFeedbackLane *lane);
     
     void keyup();
     
     bool isPlaying();
+
+    // Early retirement for inaudible release tails. releasePeak is an upper
+    // bound on the summed carrier gain (Q24, as gain_out) for the rest of
+    // the note, INT32_MAX while a key holds it. A retired note reports
+    // !isPlaying until the next init; retiredTick keeps its carrier
+    // envelopes running and returns whether it would still be playing.
+    int32_t releasePeak();
+    void retire();
+    bool retiredTick();
+
+    // Blocks until every carrier envelope is at or below floor (or has
+    // ended, with floor < 0), -1 if some carrier will not get there
+    // without a new note. See Env::releaseBlocks; a retired note still
+    // answers for its envelopes.
+    int releaseBlocks(int32_t floor);
     
     // PG:add the update
     void update(const uint8_t patch[156], int midinote, int velocity, int channel);
@@ -73,6 +95,7 @@ public:
     
 private:
     bool initialised_;
+    bool retired_;
     Env env_[6];
     FmOpParams params_[6];
     PitchEnv pitchenv_;
@@ -199,3 +199,29 @@ void Env::transfer(Env &src) {
 bool Env::isActive() {
     return initialised_ && (ix_ < 4 || levels_[3] > 0);
 }
+
+// once released the envelope only moves toward L4, so it never goes above
+// the larger of where it is now and where it is heading
+int32_t Env::releasePeak() {
+    if (down_) return INT32_MAX;
+    return level_ > targetlevel_ ? level_ : targetlevel_;
+}
+
+int Env::releaseBlocks(int32_t floor) {
+    if (down_) return -1;
+    if (floor < 0) {
+        if (levels_[3] > 0) return -1;
+        if (ix_ >= 4) return 0;
+        floor = targetlevel_;
+    } else {
+        if (level_ <= floor) return 0;
+        if (ix_ >= 4 || targetlevel_ > floor) return -1;
+    }
+    int blocks = 0;
+#ifdef ACCURATE_ENVELOPE
+    blocks += (staticcount_ + N - 1) / N;
+#endif
+    // rising here only happens from below L4 = 0, and jumps past it
+    if (rising_) return blocks + 1;
+    return blocks + (level_ - floor + inc_ - 1) / inc_;
+}
@@ -52,6 +52,13 @@ class Env {
   static void init_sr(double sample_rate);
   void transfer(Env &src);
   bool isActive();
+  // Highest level (getsample units) the envelope can still reach before
+  // the next keydown, or INT32_MAX while the key is down.
+  int32_t releasePeak();
+  // Blocks (getsample calls) until the level is at or below floor, or
+  // with floor < 0 until the envelope ends. -1 if neither happens before
+  // the next keydown: key down, or released toward a level above floor.
+  int releaseBlocks(int32_t floor);
 
  private:
   bool initialised_;
@@ -17,6 +17,8 @@
 #ifdef VERBOSE
 #include <iostream>
 #endif
+#include <math.h>
+#include <string.h>
 
 #include "synth.h"
 #include "exp2.h"
@@ -26,7 +28,8 @@
 
 //using namespace std;
 
-const FmAlgorithm FmCore::algorithms[32] = {
+// constexpr so the per-algorithm renderers below can fold the flags
+constexpr FmAlgorithm FmCore::algorithms[32] = {
   { { 0xc1, 0x11, 0x11, 0x14, 0x01, 0x14 } }, // 1
   { { 0x01, 0x11, 0x11, 0x14, 0xc1, 0x14 } }, // 2
   { { 0xc1, 0x11, 0x14, 0x01, 0x11, 0x14 } }, // 3
@@ -90,48 +93,243 @@ void FmCore::dump() {
 #endif
 }
 
-void FmCore::render(int32_t *output, FmOpParams *params, int algorithm, int32_t *fb_buf, int feedback_shift) {
-    const int kLevelThresh = 1120;
+// Operators whose gain stays below this for a whole block are skipped
+static const int kLevelThresh = 1120;
+
+template<int ALG, int OP>
+inline void FmCore::renderOp(int32_t *output, FmOpParams *params, int32_t *fb_buf,
+                             int feedback_shift, bool *has_contents) {
+    constexpr int flags = algorithms[ALG].ops[OP];
+    constexpr int inbus = (flags >> 4) & 3;
+    constexpr int outbus = flags & 3;
+    constexpr bool add_flag = (flags & OUT_BUS_ADD) != 0;
+    constexpr bool fb_op = (flags & 0xc0) == 0xc0;
+    FmOpParams &param = params[OP];
+    int32_t *outptr = (outbus == 0) ? output : buf_[outbus - 1].get();
+    int32_t gain1 = param.gain_out;
+    int32_t gain2 = Exp2::lookup(param.level_in - (14 * (1 << 24)));
+    param.gain_out = gain2;
+
+    if (gain1 >= kLevelThresh || gain2 >= kLevelThresh) {
+        bool add = add_flag && has_contents[outbus];
+        if (inbus == 0 || !has_contents[inbus]) {
+            // todo: more than one op in a feedback loop
+            if (fb_op && feedback_shift < 16) {
+                int stride;
+                const int32_t *pre = fb_count_ ? precomputedFeedback(params, &stride) : NULL;
+                if (pre == NULL) {
+                    FmOpKernel::compute_fb(outptr, param.phase, param.freq,
+                                           gain1, gain2,
+                                           fb_buf, feedback_shift, add);
+                } else if (add) {
+                    for (int i = 0; i < N; i++) outptr[i] += pre[i * stride];
+                } else {
+                    for (int i = 0; i < N; i++) outptr[i] = pre[i * stride];
+                }
+            } else {
+                FmOpKernel::compute_pure(outptr, param.phase, param.freq,
+                                         gain1, gain2, add, sine_poly_, pure_kernel_);
+            }
+        } else {
+            FmOpKernel::compute(outptr, buf_[inbus - 1].get(),
+                                param.phase, param.freq, gain1, gain2, add, sine_poly_);
+        }
+        has_contents[outbus] = true;
+        rendered_ops_++;
+    } else if (!add_flag) {
+        has_contents[outbus] = false;
+    }
+    param.phase += param.freq << LG_N;
+}
+
+template<int ALG>
+void FmCore::renderAlgorithm(int32_t *output, FmOpParams *params, int32_t *fb_buf, int feedback_shift,
+                             bool add) {
+    // Carriers all add to bus 0, so with add false the first one writes it
+    bool has_contents[3] = { add, false, false };
+    rendered_ops_ = 0;
+    renderOp<ALG, 0>(output, params, fb_buf, feedback_shift, has_contents);
+    renderOp<ALG, 1>(output, params, fb_buf, feedback_shift, has_contents);
+    renderOp<ALG, 2>(output, params, fb_buf, feedback_shift, has_contents);
+    renderOp<ALG, 3>(output, params, fb_buf, feedback_shift, has_contents);
+    renderOp<ALG, 4>(output, params, fb_buf, feedback_shift, has_contents);
+    renderOp<ALG, 5>(output, params, fb_buf, feedback_shift, has_contents);
+    if (!has_contents[0]) {
+        memset(output, 0, N * sizeof(int32_t));
+    }
+}
+
+const FmCore::AlgorithmRenderer FmCore::renderers[32] = {
+    &FmCore::renderAlgorithm<0>,  &FmCore::renderAlgorithm<1>,
+    &FmCore::renderAlgorithm<2>,  &FmCore::renderAlgorithm<3>,
+    &FmCore::renderAlgorithm<4>,  &FmCore::renderAlgorithm<5>,
+    &FmCore::renderAlgorithm<6>,  &FmCore::renderAlgorithm<7>,
+    &FmCore::renderAlgorithm<8>,  &FmCore::renderAlgorithm<9>,
+    &FmCore::renderAlgorithm<10>, &FmCore::renderAlgorithm<11>,
+    &FmCore::renderAlgorithm<12>, &FmCore::renderAlgorithm<13>,
+    &FmCore::renderAlgorithm<14>, &FmCore::renderAlgorithm<15>,
+    &FmCore::renderAlgorithm<16>, &FmCore::renderAlgorithm<17>,
+    &FmCore::renderAlgorithm<18>, &FmCore::renderAlgorithm<19>,
+    &FmCore::renderAlgorithm<20>, &FmCore::renderAlgorithm<21>,
+    &FmCore::renderAlgorithm<22>, &FmCore::renderAlgorithm<23>,
+    &FmCore::renderAlgorithm<24>, &FmCore::renderAlgorithm<25>,
+    &FmCore::renderAlgorithm<26>, &FmCore::renderAlgorithm<27>,
+    &FmCore::renderAlgorithm<28>, &FmCore::renderAlgorithm<29>,
+    &FmCore::renderAlgorithm<30>, &FmCore::renderAlgorithm<31>,
+};
+
+void FmCore::render(int32_t *output, FmOpParams *params, int algorithm, int32_t *fb_buf, int feedback_shift,
+                    bool add) {
+    (this->*renderers[algorithm])(output, params, fb_buf, feedback_shift, add);
+}
+
+void FloatFmCore::render(int32_t *output, FmOpParams *params, int algorithm, int32_t *fb_buf, int feedback_shift,
+                         bool add_out) {
     const FmAlgorithm alg = algorithms[algorithm];
-    bool has_contents[3] = { true, false, false };
+    // Unlike FmCore, the output bus starts empty: the carriers are summed
+    // in float and added to output once at the end
+    bool has_contents[3] = { false, false, false };
+    rendered_ops_ = 0;
     for (int op = 0; op < 6; op++) {
         int flags = alg.ops[op];
         bool add = (flags & OUT_BUS_ADD) != 0;
         FmOpParams &param = params[op];
         int inbus = (flags >> 4) & 3;
         int outbus = flags & 3;
-        int32_t *outptr = (outbus == 0) ? output : buf_[outbus - 1].get();
+        float *outptr = fbuf_[outbus].get();
         int32_t gain1 = param.gain_out;
         int32_t gain2 = Exp2::lookup(param.level_in - (14 * (1 << 24)));
         param.gain_out = gain2;
-        
+
         if (gain1 >= kLevelThresh || gain2 >= kLevelThresh) {
             if (!has_contents[outbus]) {
                 add = false;
             }
             if (inbus == 0 || !has_contents[inbus]) {
-                // todo: more than one op in a feedback loop
                 if ((flags & 0xc0) == 0xc0 && feedback_shift < 16) {
-                    // cout << op << " fb " << inbus << outbus << add << endl;
-                    FmOpKernel::compute_fb(outptr, param.phase, param.freq,
-                                           gain1, gain2,
-                                           fb_buf, feedback_shift, add);
+                    int stride;
+                    const int32_t *pre = fb_count_ ? precomputedFeedback(params, &stride) : NULL;
+                    if (pre == NULL) {
+                        FmOpKernel::compute_fb_float(outptr, param.phase, param.freq,
+                                                     gain1, gain2,
+                                                     fb_buf, feedback_shift, add);
+                    } else if (add) {
+                        for (int i = 0; i < N; i++) outptr[i] += (float)pre[i * stride] * (1.0f / (1 << 24));
+                    } else {
+                        for (int i = 0; i < N; i++) outptr[i] = (float)pre[i * stride] * (1.0f / (1 << 24));
+                    }
                 } else {
-                    // cout << op << " pure " << inbus << outbus << add << endl;
-                    FmOpKernel::compute_pure(outptr, param.phase, param.freq,
-                                             gain1, gain2, add);
+                    FmOpKernel::compute_pure_float(outptr, param.phase, param.freq,
+                                                   gain1, gain2, add);
                 }
             } else {
-                // cout << op << " normal " << inbus << outbus << " " << param.freq << add << endl;
-                FmOpKernel::compute(outptr, buf_[inbus - 1].get(),
-                                    param.phase, param.freq, gain1, gain2, add);
+                FmOpKernel::compute_float(outptr, fbuf_[inbus].get(),
+                                          param.phase, param.freq, gain1, gain2, add);
             }
             has_contents[outbus] = true;
+            rendered_ops_++;
         } else if (!add) {
             has_contents[outbus] = false;
         }
         param.phase += param.freq << LG_N;
     }
+
+    if (has_contents[0]) {
+        const float *out = fbuf_[0].get();
+#if SIMD_LANES > 1
+        simd_f32 to_q24 = simd_fset1((float)(1 << 24));
+        for (int i = 0; i < N; i += SIMD_LANES) {
+            simd_i32 y = simd_to_int(simd_fmul(simd_fload(out + i), to_q24));
+            simd_store(output + i, add_out ? simd_add(simd_load(output + i), y) : y);
+        }
+#else
+        for (int i = 0; i < N; i++) {
+            int32_t y = (int32_t)lrintf(out[i] * (1 << 24));
+            output[i] = add_out ? output[i] + y : y;
+        }
+#endif
+    } else if (!add_out) {
+        memset(output, 0, N * sizeof(int32_t));
+    }
+}
+
+const int32_t *FmCore::precomputedFeedback(const FmOpParams *params, int *stride) {
+    for (int k = 0; k < fb_count_; k++) {
+        if (fb_params_[k] == params) {
+            fb_params_[k] = NULL;  // use once
+            *stride = fb_stride_;
+            return fb_out_[k];
+        }
+    }
+    return NULL;
+}
+
+void FmCore::prepareFeedback(const FmFeedbackLane *lanes, int count) {
+    fb_count_ = 0;
+#if SIMD_LANES > 1
+    const int L = SIMD_LANES;
+    int op_of[kMaxFeedbackLanes];
+    bool pending[kMaxFeedbackLanes];
+    if (count > kMaxFeedbackLanes) count = kMaxFeedbackLanes;
+
+    // Same conditions under which render() would run compute_fb
+    for (int j = 0; j < count; j++) {
+        const FmFeedbackLane &lane = lanes[j];
+        op_of[j] = -1;
+        pending[j] = false;
+        if (lane.fb_shift >= 16) continue;
+        for (int op = 0; op < 6; op++) {
+            if ((algorithms[lane.algorithm].ops[op] & 0xc0) == 0xc0) op_of[j] = op;
+        }
+        if (op_of[j] < 0) continue;
+        const FmOpParams &param = lane.params[op_of[j]];
+        int32_t gain2 = Exp2::lookup(param.level_in - (14 * (1 << 24)));
+        pending[j] = param.gain_out >= kLevelThresh || gain2 >= kLevelThresh;
+    }
+
+    // Lanes of one kernel call must share fb_shift; spare lanes repeat the first
+    int32_t *out = fb_batch_.get();
+    int32_t *out_end = out + N * kMaxFeedbackLanes;
+    fb_stride_ = L;
+    for (int j = 0; j < count && out + N * L <= out_end; j++) {
+        if (!pending[j]) continue;
+        int shift = lanes[j].fb_shift;
+        int members[SIMD_LANES];
+        int n = 0;
+        for (int m = j; m < count && n < L; m++) {
+            if (pending[m] && lanes[m].fb_shift == shift) {
+                members[n++] = m;
+                pending[m] = false;
+            }
+        }
+
+        int32_t phase[SIMD_LANES], freq[SIMD_LANES], gain1[SIMD_LANES], gain2[SIMD_LANES];
+        int32_t y0[SIMD_LANES], y[SIMD_LANES];
+        for (int k = 0; k < L; k++) {
+            const FmFeedbackLane &lane = lanes[members[k < n ? k : 0]];
+            const FmOpParams &param = lane.params[op_of[members[k < n ? k : 0]]];
+            phase[k] = param.phase;
+            freq[k] = param.freq;
+            gain1[k] = param.gain_out;
+            gain2[k] = Exp2::lookup(param.level_in - (14 * (1 << 24)));
+            y0[k] = lane.fb_buf[0];
+            y[k] = lane.fb_buf[1];
+        }
+        FmOpKernel::compute_fb_lanes(out, phase, freq, gain1, gain2, y0, y, shift);
+        for (int k = 0; k < n; k++) {
+            const FmFeedbackLane &lane = lanes[members[k]];
+            lane.fb_buf[0] = y0[k];
+            lane.fb_buf[1] = y[k];
+            fb_params_[fb_count_] = lane.params;
+            fb_out_[fb_count_] = out + k;
+            fb_count_++;
+        }
+        out += N * L;
+    }
+#else
+    (void)lanes;
+    (void)count;
+#endif
 }
 
 bool FmCore::isCarrier(int algorithm, int op) {
@@ -44,15 +44,89 @@ public:
     int ops[6];
 };
 
+// One note's view for FmCore::prepareFeedback
+struct FmFeedbackLane {
+    FmOpParams *params;
+    int algorithm;
+    int32_t *fb_buf;
+    int fb_shift;
+};
+
+// The polynomial sine wins where the table gather is expensive. AVX2's
+// gather is slow; SSE4.1 and scalar builds measure about even or slower.
+// NEON has no gather at all, but keeps the table until the polynomial has
+// been measured on the device.
+#if defined(SIMD_AVX2)
+static const bool kSinePolyDefault = true;
+#else
+static const bool kSinePolyDefault = false;
+#endif
+
 class FmCore {
 public:
     virtual ~FmCore() {};
     static void dump();
     static bool isCarrier(int algorithm, int op);
-    virtual void render(int32_t *output, FmOpParams *params, int algorithm, int32_t *fb_buf, int32_t feedback_gain);
+    // Adds the carriers to output, or with add false overwrites it (zeroing
+    // it when no carrier is above the level threshold)
+    virtual void render(int32_t *output, FmOpParams *params, int algorithm, int32_t *fb_buf,
+                        int32_t feedback_gain, bool add);
+    // Operators computed by the last render(); the others were below the level threshold
+    int renderedOps() const { return rendered_ops_; }
+
+    // Compute the self-feedback operator of up to kMaxFeedbackLanes notes
+    // together, one note per SIMD lane (compute_fb cannot be vectorized
+    // along time). Call after each note's params are computed; the next
+    // render() of each of those notes uses the stored output instead of
+    // running compute_fb. A no-op without SIMD.
+    void prepareFeedback(const FmFeedbackLane *lanes, int count);
+    static const int kMaxFeedbackLanes = 16;
+
+    // Operator sine source: Sin::poly instead of the interpolated sintab
+    // (see FmOpKernel::compute). Float cores always use Sin::polyf.
+    void setSinePoly(bool poly) { sine_poly_ = poly; }
+    bool sinePoly() const { return sine_poly_; }
+
+    // Kernel for unmodulated operators (see FmOpKernel::compute_pure)
+    void setPureKernel(FmOpKernel::PureKernel pure) { pure_kernel_ = pure; }
+    FmOpKernel::PureKernel pureKernel() const { return pure_kernel_; }
 protected:
     AlignedBuf<int32_t, N>buf_[2];
+    int rendered_ops_ = 0;
+    bool sine_poly_ = kSinePolyDefault;
+    FmOpKernel::PureKernel pure_kernel_ = FmOpKernel::PURE_SINE;
+
+    // prepareFeedback results: lane k's samples are fb_out_[k] with stride fb_stride_
+    const int32_t *precomputedFeedback(const FmOpParams *params, int *stride);
+    AlignedBuf<int32_t, N * kMaxFeedbackLanes> fb_batch_;
+    const FmOpParams *fb_params_[kMaxFeedbackLanes];
+    const int32_t *fb_out_[kMaxFeedbackLanes];
+    int fb_stride_ = 1;
+    int fb_count_ = 0;
     const static FmAlgorithm algorithms[32];
+
+    // render() for one algorithm with its routing resolved at compile
+    // time; render() dispatches through a table of these
+    template<int ALG>
+    void renderAlgorithm(int32_t *output, FmOpParams *params, int32_t *fb_buf, int feedback_shift,
+                         bool add);
+    template<int ALG, int OP>
+    void renderOp(int32_t *output, FmOpParams *params, int32_t *fb_buf, int feedback_shift,
+                  bool *has_contents);
+    typedef void (FmCore::*AlgorithmRenderer)(int32_t *, FmOpParams *, int32_t *, int, bool);
+    const static AlgorithmRenderer renderers[32];
+};
+
+// Same algorithms and level skipping as FmCore, but operator outputs,
+// gain ramps and the buses are float (see FmOpKernel::compute_float);
+// phases stay integer. render() adds the carriers into the int32 Q24
+// output like FmCore, and uses prepareFeedback results the same way.
+class FloatFmCore : public FmCore {
+public:
+    void render(int32_t *output, FmOpParams *params, int algorithm, int32_t *fb_buf,
+                int32_t feedback_shift, bool add) override;
+protected:
+    AlignedBuf<float, N> fbuf_[3];  // output bus, then buses 1 and 2
 };
 
 #endif  // __FM_CORE_H
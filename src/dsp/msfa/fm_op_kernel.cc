@@ -18,94 +18,286 @@
 
 #include <cstdlib>
 
-#ifdef HAVE_NEON
-#include <cpu-features.h>
-#endif
-
 #include "synth.h"
 #include "sin.h"
+#include "simd.h"
+#include "aligned_buf.h"
 #include "fm_op_kernel.h"
 
-#ifdef HAVE_NEONx
-static bool hasNeon() {
-  return true;
-  return (android_getCpuFeatures() & ANDROID_CPU_ARM_FEATURE_NEON) != 0;
+#if SIMD_LANES > 1
+// Sin::lookup on every lane. |dy| < 2^17 and lowbits < 2^14, so the
+// interpolation product fits in 32 bits and needs no widening multiply.
+static inline simd_i32 sin_lookup_simd(simd_i32 phase) {
+  const int SHIFT = 24 - SIN_LG_N_SAMPLES;
+  simd_i32 lowbits = simd_and(phase, simd_set1((1 << SHIFT) - 1));
+  simd_i32 phase_int = simd_and(simd_srai<SHIFT - 1>(phase),
+                                simd_set1((SIN_N_SAMPLES - 1) << 1));
+  simd_i32 dy, y0;
+  simd_gather_pairs(sintab, phase_int, &dy, &y0);
+  return simd_add(y0, simd_srai<SHIFT>(simd_mullo(dy, lowbits)));
 }
 
-extern "C"
-void neon_fm_kernel(const int *in, const int *busin, int *out, int count,
-  int32_t phase0, int32_t freq, int32_t gain1, int32_t dgain);
+// Sin::poly on every lane
+static inline simd_i32 sin_poly_simd(simd_i32 phase) {
+  simd_i32 x = simd_sub(simd_and(phase, simd_set1((1 << 23) - 1)), simd_set1(1 << 22));
+  simd_f32 t = simd_fmul(simd_to_float(x), simd_fset1(1.0f / (1 << 22)));
+  simd_f32 u = simd_fmul(t, t);
+  simd_f32 y = simd_fset1(SIN_POLY_8);
+  y = simd_fadd(simd_fmul(y, u), simd_fset1(SIN_POLY_6));
+  y = simd_fadd(simd_fmul(y, u), simd_fset1(SIN_POLY_4));
+  y = simd_fadd(simd_fmul(y, u), simd_fset1(SIN_POLY_2));
+  y = simd_fadd(simd_fmul(y, u), simd_fset1(SIN_POLY_0));
+  simd_i32 r = simd_to_int(simd_fmul(y, simd_fset1((float)(1 << 24))));
+  simd_i32 s = simd_srai<31>(simd_slli<8>(phase));
+  return simd_sub(simd_xor(r, s), s);
+}
 
-const int32_t __attribute__ ((aligned(16))) zeros[N] = {0};
+// compute / compute_pure across SIMD_LANES samples at a time; lane k of
+// step i handles sample i + k, with the same wrapping phase and gain
+// accumulators as the scalar loops.
+template<bool ADD, bool INPUT, bool POLY>
+static inline void fm_op_simd(int32_t *output, const int32_t *input,
+                              int32_t phase0, int32_t freq,
+                              int32_t gain1, int32_t dgain) {
+  simd_i32 phase = simd_ramp(phase0, freq);
+  simd_i32 gain = simd_ramp((int32_t)((uint32_t)gain1 + (uint32_t)dgain), dgain);
+  simd_i32 phase_step = simd_set1((int32_t)((uint32_t)freq * SIMD_LANES));
+  simd_i32 gain_step = simd_set1((int32_t)((uint32_t)dgain * SIMD_LANES));
+  for (int i = 0; i < N; i += SIMD_LANES) {
+    simd_i32 p = INPUT ? simd_add(phase, simd_load(input + i)) : phase;
+    simd_i32 s = POLY ? sin_poly_simd(p) : sin_lookup_simd(p);
+    simd_i32 y = simd_mul_shr<24>(s, gain);
+    if (ADD) y = simd_add(y, simd_load(output + i));
+    simd_store(output + i, y);
+    phase = simd_add(phase, phase_step);
+    gain = simd_add(gain, gain_step);
+  }
+}
 
-#else
-static bool hasNeon() {
-  return false;
+template<bool INPUT>
+static inline void fm_op_simd(int32_t *output, const int32_t *input,
+                              int32_t phase0, int32_t freq,
+                              int32_t gain1, int32_t dgain, bool add, bool poly) {
+  if (poly) {
+    if (add) fm_op_simd<true, INPUT, true>(output, input, phase0, freq, gain1, dgain);
+    else fm_op_simd<false, INPUT, true>(output, input, phase0, freq, gain1, dgain);
+  } else {
+    if (add) fm_op_simd<true, INPUT, false>(output, input, phase0, freq, gain1, dgain);
+    else fm_op_simd<false, INPUT, false>(output, input, phase0, freq, gain1, dgain);
+  }
 }
 #endif
 
-void FmOpKernel::compute(int32_t *output, const int32_t *input,
-                         int32_t phase0, int32_t freq,
-                         int32_t gain1, int32_t gain2, bool add) {
-  int32_t dgain = (gain2 - gain1 + (N >> 1)) >> LG_N;
+// Scalar loop shared by compute and compute_pure
+template<bool ADD, bool INPUT, bool POLY>
+static inline void fm_op_scalar(int32_t *output, const int32_t *input,
+                                int32_t phase0, int32_t freq,
+                                int32_t gain1, int32_t dgain) {
   int32_t gain = gain1;
   int32_t phase = phase0;
-  if (hasNeon()) {
-#ifdef HAVE_NEON
-    neon_fm_kernel(input, add ? output : zeros, output, N,
-      phase0, freq, gain, dgain);
-#endif
+  for (int i = 0; i < N; i++) {
+    gain += dgain;
+    int32_t p = INPUT ? phase + input[i] : phase;
+    int32_t y = POLY ? Sin::poly(p) : Sin::lookup(p);
+    int32_t y1 = ((int64_t)y * (int64_t)gain) >> 24;
+    if (ADD) {
+      output[i] += y1;
+    } else {
+      output[i] = y1;
+    }
+    phase += freq;
+  }
+}
+
+template<bool INPUT>
+static inline void fm_op_scalar(int32_t *output, const int32_t *input,
+                                int32_t phase0, int32_t freq,
+                                int32_t gain1, int32_t dgain, bool add, bool poly) {
+  if (poly) {
+    if (add) fm_op_scalar<true, INPUT, true>(output, input, phase0, freq, gain1, dgain);
+    else fm_op_scalar<false, INPUT, true>(output, input, phase0, freq, gain1, dgain);
   } else {
-    if (add) {
-      for (int i = 0; i < N; i++) {
-        gain += dgain;
-        int32_t y = Sin::lookup(phase + input[i]);
-        int32_t y1 = ((int64_t)y * (int64_t)gain) >> 24;
-        output[i] += y1;
-        phase += freq;
-      }
+    if (add) fm_op_scalar<true, INPUT, false>(output, input, phase0, freq, gain1, dgain);
+    else fm_op_scalar<false, INPUT, false>(output, input, phase0, freq, gain1, dgain);
+  }
+}
+
+// compute_pure from a second-order sine recurrence (PURE_RESONATOR and
+// PURE_DIFF), the two best of the experiments at the end of this file.
+// The block is split into kRecStreams interleaved streams, stream k making
+// samples k, k + K, ..., so every stream steps by K * freq and the
+// streams are independent: one per SIMD lane, or four in a scalar build
+// to hide the multiply latency. Each call reseeds the streams from the
+// exact phase, which is the drift correction: error builds up over at most
+// N / K steps and never crosses a block boundary. Sine and cosine of the
+// phase come from the cheap sine of the build (Sin::poly lanes with SIMD,
+// the table without), the step's coefficients from the more accurate
+// Sin::compute10. The second state is rotated from those rather than
+// looked up on its own: at low frequencies u and u_prev are nearly equal
+// and independent lookup errors in them would be amplified many times.
+//
+// With u the unit sine in Q29 and w = K * 2 pi freq:
+//   resonator  u' = a * u - u_prev                a = 2cos(w)
+//   diff       v' = v - aa * u,  u' = u + v'       aa = 4sin^2(w / 2)
+// The diff form carries the small per-step change in v instead of taking
+// it as the difference of two nearly equal values, which holds up better
+// at low frequencies.
+static const int kRecStreams = SIMD_LANES > 1 ? SIMD_LANES : 4;
+
+// Coefficients for a stream step of s = K * freq: *c is a or aa in Q29,
+// *sn is sin(s) in Q30. The second state is then, from u = sin(p) and
+// v = cos(p):
+//   resonator  u_prev = sin(p - s) = a/2 * u - sn * v
+//   diff       u - u_prev          = aa/2 * u + sn * v
+template<bool DIFF>
+static inline void rec_coef(int32_t freq, int32_t *c, int32_t *sn) {
+  uint32_t step = (uint32_t)freq * kRecStreams;
+  *sn = Sin::compute10((int32_t)(step << 6));
+  if (DIFF) {
+    // (2sin(s / 2))^2, sin(s / 2) in Q30 from the step within one cycle
+    int32_t sh = Sin::compute10((int32_t)((step & 0xffffff) << 5));
+    int64_t aa = ((int64_t)sh * (int64_t)sh) >> 29;
+    // 4.0 itself (exactly Nyquist / K) does not fit
+    *c = aa > INT32_MAX ? INT32_MAX : (int32_t)aa;
+  } else {
+    // cos in Q30 is 2cos in Q29
+    *c = Sin::compute10((int32_t)((step << 6) + (1 << 28)));
+  }
+}
+
+#if SIMD_LANES > 1
+template<bool ADD, bool DIFF>
+static inline void fm_pure_rec(int32_t *output, int32_t phase0, int32_t freq,
+                               int32_t gain1, int32_t dgain) {
+  int32_t c0, sn0;
+  rec_coef<DIFF>(freq, &c0, &sn0);
+  simd_i32 c = simd_set1(c0);
+  simd_i32 phase = simd_ramp(phase0, freq);
+  simd_i32 u = simd_slli<5>(sin_poly_simd(phase));
+  simd_i32 v = simd_slli<5>(sin_poly_simd(simd_add(phase, simd_set1(1 << 22))));
+  simd_i32 cu = simd_mul_shr<30>(c, u);
+  simd_i32 sv = simd_mul_shr<30>(simd_set1(sn0), v);
+  simd_i32 w = DIFF ? simd_add(cu, sv) : simd_sub(cu, sv);
+  simd_i32 gain = simd_ramp((int32_t)((uint32_t)gain1 + (uint32_t)dgain), dgain);
+  simd_i32 gain_step = simd_set1((int32_t)((uint32_t)dgain * SIMD_LANES));
+  for (int i = 0; i < N; i += SIMD_LANES) {
+    simd_i32 y = simd_mul_shr<29>(u, gain);
+    if (ADD) y = simd_add(y, simd_load(output + i));
+    simd_store(output + i, y);
+    gain = simd_add(gain, gain_step);
+    if (DIFF) {
+      w = simd_sub(w, simd_mul_shr<29>(c, u));
+      u = simd_add(u, w);
     } else {
-      for (int i = 0; i < N; i++) {
-        gain += dgain;
-        int32_t y = Sin::lookup(phase + input[i]);
-        int32_t y1 = ((int64_t)y * (int64_t)gain) >> 24;
-        output[i] = y1;
-        phase += freq;
+      simd_i32 t = simd_sub(simd_mul_shr<29>(c, u), w);
+      w = u;
+      u = t;
+    }
+  }
+}
+#else
+template<bool ADD, bool DIFF>
+static inline void fm_pure_rec(int32_t *output, int32_t phase0, int32_t freq,
+                               int32_t gain1, int32_t dgain) {
+  int32_t u[kRecStreams], w[kRecStreams], gain[kRecStreams];
+  int32_t c, sn;
+  rec_coef<DIFF>(freq, &c, &sn);
+  for (int k = 0; k < kRecStreams; k++) {
+    int32_t p = (int32_t)((uint32_t)phase0 + (uint32_t)k * (uint32_t)freq);
+    u[k] = Sin::lookup(p) << 5;
+    int32_t v = Sin::lookup(p + (1 << 22)) << 5;
+    int32_t cu = ((int64_t)c * (int64_t)u[k]) >> 30;
+    int32_t sv = ((int64_t)sn * (int64_t)v) >> 30;
+    w[k] = DIFF ? cu + sv : cu - sv;
+    gain[k] = (int32_t)((uint32_t)gain1 + (uint32_t)(k + 1) * (uint32_t)dgain);
+  }
+  int32_t gain_step = (int32_t)((uint32_t)dgain * kRecStreams);
+  for (int i = 0; i < N; i += kRecStreams) {
+    for (int k = 0; k < kRecStreams; k++) {
+      int32_t y = ((int64_t)u[k] * (int64_t)gain[k]) >> 29;
+      if (ADD) {
+        output[i + k] += y;
+      } else {
+        output[i + k] = y;
+      }
+      gain[k] += gain_step;
+      if (DIFF) {
+        w[k] -= ((int64_t)c * (int64_t)u[k]) >> 29;
+        u[k] += w[k];
+      } else {
+        int32_t t = (((int64_t)c * (int64_t)u[k]) >> 29) - w[k];
+        w[k] = u[k];
+        u[k] = t;
       }
     }
   }
 }
+#endif
+
+static inline void fm_pure_rec(int32_t *output, int32_t phase0, int32_t freq,
+                               int32_t gain1, int32_t dgain, bool add, bool diff) {
+  if (diff) {
+    if (add) fm_pure_rec<true, true>(output, phase0, freq, gain1, dgain);
+    else fm_pure_rec<false, true>(output, phase0, freq, gain1, dgain);
+  } else {
+    if (add) fm_pure_rec<true, false>(output, phase0, freq, gain1, dgain);
+    else fm_pure_rec<false, false>(output, phase0, freq, gain1, dgain);
+  }
+}
+
+void FmOpKernel::compute(int32_t *output, const int32_t *input,
+                         int32_t phase0, int32_t freq,
+                         int32_t gain1, int32_t gain2, bool add, bool poly) {
+  int32_t dgain = (gain2 - gain1 + (N >> 1)) >> LG_N;
+#if SIMD_LANES > 1
+  fm_op_simd<true>(output, input, phase0, freq, gain1, dgain, add, poly);
+#else
+  fm_op_scalar<true>(output, input, phase0, freq, gain1, dgain, add, poly);
+#endif
+}
 
 void FmOpKernel::compute_pure(int32_t *output, int32_t phase0, int32_t freq,
-                              int32_t gain1, int32_t gain2, bool add) {
+                              int32_t gain1, int32_t gain2, bool add, bool poly,
+                              PureKernel pure) {
   int32_t dgain = (gain2 - gain1 + (N >> 1)) >> LG_N;
-  int32_t gain = gain1;
-  int32_t phase = phase0;
-  if (hasNeon()) {
-#ifdef HAVE_NEON
-    neon_fm_kernel(zeros, add ? output : zeros, output, N,
-      phase0, freq, gain, dgain);
+  if (pure != PURE_SINE) {
+    fm_pure_rec(output, phase0, freq, gain1, dgain, add, pure == PURE_DIFF);
+    return;
+  }
+#if SIMD_LANES > 1
+  fm_op_simd<false>(output, NULL, phase0, freq, gain1, dgain, add, poly);
+#else
+  fm_op_scalar<false>(output, NULL, phase0, freq, gain1, dgain, add, poly);
 #endif
-  } else {
-    if (add) {
-      for (int i = 0; i < N; i++) {
-        gain += dgain;
-        int32_t y = Sin::lookup(phase);
-        int32_t y1 = ((int64_t)y * (int64_t)gain) >> 24;
-        output[i] += y1;
-        phase += freq;
-      }
-    } else {
-      for (int i = 0; i < N; i++) {
-        gain += dgain;
-        int32_t y = Sin::lookup(phase);
-        int32_t y1 = ((int64_t)y * (int64_t)gain) >> 24;          
-        output[i] = y1;
-        phase += freq;
-      }
-    }
+}
+
+#if SIMD_LANES > 1
+void FmOpKernel::compute_fb_lanes(int32_t *output, const int32_t *phase0,
+                                  const int32_t *freq, const int32_t *gain1,
+                                  const int32_t *gain2, int32_t *fb_y0,
+                                  int32_t *fb_y, int fb_shift) {
+  int32_t dgain[SIMD_LANES];
+  for (int k = 0; k < SIMD_LANES; k++) {
+    dgain[k] = (gain2[k] - gain1[k] + (N >> 1)) >> LG_N;
+  }
+  simd_i32 vdgain = simd_load(dgain);
+  simd_i32 vfreq = simd_load(freq);
+  simd_i32 gain = simd_load(gain1);
+  simd_i32 phase = simd_load(phase0);
+  simd_i32 y0 = simd_load(fb_y0);
+  simd_i32 y = simd_load(fb_y);
+  for (int i = 0; i < N; i++) {
+    gain = simd_add(gain, vdgain);
+    simd_i32 scaled_fb = simd_sra(simd_add(y0, y), fb_shift + 1);
+    y0 = y;
+    y = simd_mul_shr<24>(sin_lookup_simd(simd_add(phase, scaled_fb)), gain);
+    simd_store(output + i * SIMD_LANES, y);
+    phase = simd_add(phase, vfreq);
   }
+  simd_store(fb_y0, y0);
+  simd_store(fb_y, y);
 }
+#endif
 
 #define noDOUBLE_ACCURACY
 #define HIGH_ACCURACY
@@ -143,12 +335,129 @@ void FmOpKernel::compute_fb(int32_t *output, int32_t phase0, int32_t freq,
   fb_buf[1] = y;
 }
 
+// Float kernels. The gain ramp uses the same rounded Q24 step as the
+// integer kernels, so levels track them exactly up to float rounding.
+static const float kQ24ToFloat = 1.0f / (1 << 24);
+
+#if SIMD_LANES > 1
+// Sin::polyf on every lane
+static inline simd_f32 sin_polyf_simd(simd_i32 phase) {
+  simd_i32 x = simd_sub(simd_and(phase, simd_set1((1 << 23) - 1)), simd_set1(1 << 22));
+  simd_f32 t = simd_fmul(simd_to_float(x), simd_fset1(1.0f / (1 << 22)));
+  simd_f32 u = simd_fmul(t, t);
+  simd_f32 y = simd_fset1(SIN_POLY_8);
+  y = simd_fadd(simd_fmul(y, u), simd_fset1(SIN_POLY_6));
+  y = simd_fadd(simd_fmul(y, u), simd_fset1(SIN_POLY_4));
+  y = simd_fadd(simd_fmul(y, u), simd_fset1(SIN_POLY_2));
+  y = simd_fadd(simd_fmul(y, u), simd_fset1(SIN_POLY_0));
+  return simd_fflip(y, simd_slli<8>(simd_and(phase, simd_set1(1 << 23))));
+}
+
+template<bool ADD, bool INPUT>
+static inline void fm_op_float_simd(float *output, const float *input,
+                                    int32_t phase0, int32_t freq,
+                                    int32_t gain1, int32_t dgain) {
+  float lanes[SIMD_LANES];
+  for (int k = 0; k < SIMD_LANES; k++) {
+    lanes[k] = (float)gain1 * kQ24ToFloat + (float)dgain * kQ24ToFloat * (k + 1);
+  }
+  simd_f32 gain = simd_fload(lanes);
+  simd_f32 gain_step = simd_fset1((float)dgain * kQ24ToFloat * SIMD_LANES);
+  simd_i32 phase = simd_ramp(phase0, freq);
+  simd_i32 phase_step = simd_set1((int32_t)((uint32_t)freq * SIMD_LANES));
+  simd_f32 to_q24 = simd_fset1((float)(1 << 24));
+  for (int i = 0; i < N; i += SIMD_LANES) {
+    simd_i32 p = phase;
+    if (INPUT) p = simd_add(p, simd_to_int(simd_fmul(simd_fload(input + i), to_q24)));
+    simd_f32 y = simd_fmul(sin_polyf_simd(p), gain);
+    if (ADD) y = simd_fadd(y, simd_fload(output + i));
+    simd_fstore(output + i, y);
+    phase = simd_add(phase, phase_step);
+    gain = simd_fadd(gain, gain_step);
+  }
+}
+#else
+template<bool ADD, bool INPUT>
+static inline void fm_op_float_scalar(float *output, const float *input,
+                                      int32_t phase0, int32_t freq,
+                                      int32_t gain1, int32_t dgain) {
+  float gain = (float)gain1 * kQ24ToFloat;
+  float step = (float)dgain * kQ24ToFloat;
+  int32_t phase = phase0;
+  for (int i = 0; i < N; i++) {
+    gain += step;
+    int32_t p = INPUT ? phase + (int32_t)lrintf(input[i] * (1 << 24)) : phase;
+    float y = Sin::polyf(p) * gain;
+    if (ADD) {
+      output[i] += y;
+    } else {
+      output[i] = y;
+    }
+    phase += freq;
+  }
+}
+#endif
+
+template<bool INPUT>
+static inline void fm_op_float(float *output, const float *input,
+                               int32_t phase0, int32_t freq,
+                               int32_t gain1, int32_t gain2, bool add) {
+  int32_t dgain = (gain2 - gain1 + (N >> 1)) >> LG_N;
+#if SIMD_LANES > 1
+  if (add) fm_op_float_simd<true, INPUT>(output, input, phase0, freq, gain1, dgain);
+  else fm_op_float_simd<false, INPUT>(output, input, phase0, freq, gain1, dgain);
+#else
+  if (add) fm_op_float_scalar<true, INPUT>(output, input, phase0, freq, gain1, dgain);
+  else fm_op_float_scalar<false, INPUT>(output, input, phase0, freq, gain1, dgain);
+#endif
+}
+
+void FmOpKernel::compute_float(float *output, const float *input,
+                               int32_t phase0, int32_t freq,
+                               int32_t gain1, int32_t gain2, bool add) {
+  fm_op_float<true>(output, input, phase0, freq, gain1, gain2, add);
+}
+
+void FmOpKernel::compute_pure_float(float *output, int32_t phase0, int32_t freq,
+                                    int32_t gain1, int32_t gain2, bool add) {
+  fm_op_float<false>(output, NULL, phase0, freq, gain1, gain2, add);
+}
+
+// The feedback recurrence is serial, so it stays the integer one of
+// compute_fb (table sine, Q24 history); a float sine and gain would only
+// lengthen the dependency chain. Just the output is float.
+void FmOpKernel::compute_fb_float(float *output, int32_t phase0, int32_t freq,
+                                  int32_t gain1, int32_t gain2,
+                                  int32_t *fb_buf, int fb_shift, bool add) {
+  int32_t dgain = (gain2 - gain1 + (N >> 1)) >> LG_N;
+  int32_t gain = gain1;
+  int32_t phase = phase0;
+  int32_t y0 = fb_buf[0];
+  int32_t y = fb_buf[1];
+  for (int i = 0; i < N; i++) {
+    gain += dgain;
+    int32_t scaled_fb = (y0 + y) >> (fb_shift + 1);
+    y0 = y;
+    y = Sin::lookup(phase + scaled_fb);
+    y = ((int64_t)y * (int64_t)gain) >> 24;
+    if (add) {
+      output[i] += (float)y * kQ24ToFloat;
+    } else {
+      output[i] = (float)y * kQ24ToFloat;
+    }
+    phase += freq;
+  }
+  fb_buf[0] = y0;
+  fb_buf[1] = y;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////
 
-// Experimental sine wave generators below
+// Experimental sine wave generators below, kept for their measurements.
+// The last two became PURE_DIFF and PURE_RESONATOR (fm_pure_rec).
 #if 0
 // Results: accuracy 64.3 mean, 170 worst case
 // high accuracy: 5.0 mean, 49 worst case
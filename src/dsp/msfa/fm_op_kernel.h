@@ -17,6 +17,8 @@
 #ifndef __FM_OP_KERNEL_H
 #define __FM_OP_KERNEL_H
 
+#include "simd.h"
+
 struct FmOpParams {
     int32_t level_in;      // value to be computed (from level to gain[0])
     int32_t gain_out;      // computed value (gain[1] to gain[0])
@@ -29,19 +31,55 @@ class FmOpKernel {
   // gain1 and gain2 represent linear step: gain for sample i is
   // gain1 + (1 + i) / 64 * (gain2 - gain1)
 
+  // poly selects the sine source of compute and compute_pure: Sin::poly,
+  // which needs no table gather, instead of the interpolated sintab. FmCore
+  // holds the choice (FmCore::setSinePoly).
+
   // This is the basic FM operator. No feedback.
   static void compute(int32_t *output, const int32_t *input,
                       int32_t phase0, int32_t freq,
-                      int32_t gain1, int32_t gain2, bool add);
-  
+                      int32_t gain1, int32_t gain2, bool add, bool poly);
+
+  // compute_pure either evaluates the sine source per sample (PURE_SINE,
+  // default) or runs a second-order recurrence reseeded every block:
+  // the resonator u' = 2cos(w) u - u_prev or its difference form. FmCore
+  // holds the choice (FmCore::setPureKernel).
+  enum PureKernel { PURE_SINE = 0, PURE_RESONATOR, PURE_DIFF };
+
   // This is a sine generator, no feedback.
   static void compute_pure(int32_t *output, int32_t phase0, int32_t freq,
-                           int32_t gain1, int32_t gain2, bool add);
+                           int32_t gain1, int32_t gain2, bool add, bool poly,
+                           PureKernel pure);
 
   // One op with feedback, no add.
   static void compute_fb(int32_t *output, int32_t phase0, int32_t freq,
                          int32_t gain1, int32_t gain2,
                          int32_t *fb_buf, int fb_gain, bool add);
+
+  // Float variants for FloatFmCore. Samples are float with 1.0 at full
+  // scale (1 << 24 in the kernels above); phase, freq and the gains stay
+  // the same Q24 integers. compute_float and compute_pure_float always
+  // use Sin::polyf; compute_fb_float runs the integer recurrence of
+  // compute_fb, so fb_buf means the same in both cores.
+  static void compute_float(float *output, const float *input,
+                            int32_t phase0, int32_t freq,
+                            int32_t gain1, int32_t gain2, bool add);
+  static void compute_pure_float(float *output, int32_t phase0, int32_t freq,
+                                 int32_t gain1, int32_t gain2, bool add);
+  static void compute_fb_float(float *output, int32_t phase0, int32_t freq,
+                               int32_t gain1, int32_t gain2,
+                               int32_t *fb_buf, int fb_shift, bool add);
+
+#if SIMD_LANES > 1
+  // compute_fb (no add) for SIMD_LANES independent operators sharing
+  // fb_shift, one per lane. Lane k takes phase0[k].. and fb_y0[k]/fb_y[k]
+  // (fb_buf[0]/fb_buf[1]), updates the latter and writes sample i to
+  // output[i * SIMD_LANES + k].
+  static void compute_fb_lanes(int32_t *output, const int32_t *phase0,
+                               const int32_t *freq, const int32_t *gain1,
+                               const int32_t *gain2, int32_t *fb_y0,
+                               int32_t *fb_y, int fb_shift);
+#endif
 };
 
 #endif
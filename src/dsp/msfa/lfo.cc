@@ -51,7 +51,7 @@ uint32_t Lfo::lforatio_;
 
 void Lfo::init(double sample_rate) {
     // constant is 1 << 32 / 15.5s / 11
-    Lfo::unit_ = (int32_t)(N * 25190424 / sample_rate + 0.5);
+    Lfo::unit_ = (int32_t)(N * 25190424.0 / sample_rate + 0.5);
 
     double ratio = 4437500000.0 * N;
     Lfo::lforatio_ = ratio / sample_rate;
@@ -116,6 +116,18 @@ int32_t Lfo::getdelay() {
     }
 }
 
+void Lfo::skip(uint32_t n) {
+    uint64_t end = (uint64_t)phase_ + (uint64_t)delta_ * n;
+    if (waveform_ == 5) {
+        // One s&h step per wrap; the step is a permutation of 256 states,
+        // so its order divides 256
+        for (uint32_t k = (uint32_t)(end >> 32) & 0xff; k > 0; k--) {
+            randstate_ = (randstate_ * 179 + 17) & 0xff;
+        }
+    }
+    phase_ = (uint32_t)end;
+}
+
 void Lfo::keydown() {
     if (sync_) {
         phase_ = (1U << 31) - 1;
@@ -30,6 +30,10 @@ public:
 
     void keydown();
 
+    // Advance the phase as n getsample() calls would, in O(1). The delay
+    // is left alone; keydown restarts it.
+    void skip(uint32_t n);
+
 private:
     static uint32_t lforatio_;
     static uint32_t unit_;
@@ -0,0 +1,331 @@
+/*
+ * Minimal integer SIMD layer for the operator kernels.
+ *
+ * One vector type, simd_i32, holding SIMD_LANES int32 lanes:
+ *   NEON (aarch64, what ships on the Move)   4 lanes
+ *   AVX2                                     8 lanes
+ *   SSE4.1                                   4 lanes
+ * Without any of these (or with -DDEXED_NO_SIMD) SIMD_LANES is 1 and
+ * callers keep their scalar loops. x86 backends exist so kernel changes
+ * can be developed and checked against the golden corpus on a desktop;
+ * build with CXXFLAGS=-msse4.1 or -mavx2 to enable them.
+ *
+ * Every operation matches the scalar int32/int64 arithmetic of the
+ * kernels bit for bit, including wraparound.
+ */
+
+#ifndef __SIMD_H
+#define __SIMD_H
+
+#include <stdint.h>
+
+#if defined(DEXED_NO_SIMD)
+#define SIMD_LANES 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define SIMD_NEON 1
+#define SIMD_LANES 4
+typedef int32x4_t simd_i32;
+typedef float32x4_t simd_f32;
+#elif defined(__AVX2__)
+#include <immintrin.h>
+#define SIMD_AVX2 1
+#define SIMD_LANES 8
+typedef __m256i simd_i32;
+typedef __m256 simd_f32;
+#elif defined(__SSE4_1__)
+#include <smmintrin.h>
+#define SIMD_SSE4 1
+#define SIMD_LANES 4
+typedef __m128i simd_i32;
+typedef __m128 simd_f32;
+#else
+#define SIMD_LANES 1
+#endif
+
+#if SIMD_LANES > 1
+
+static inline simd_i32 simd_load(const int32_t *p) {
+#if defined(SIMD_NEON)
+  return vld1q_s32(p);
+#elif defined(SIMD_AVX2)
+  return _mm256_loadu_si256((const __m256i *)p);
+#else
+  return _mm_loadu_si128((const __m128i *)p);
+#endif
+}
+
+static inline void simd_store(int32_t *p, simd_i32 v) {
+#if defined(SIMD_NEON)
+  vst1q_s32(p, v);
+#elif defined(SIMD_AVX2)
+  _mm256_storeu_si256((__m256i *)p, v);
+#else
+  _mm_storeu_si128((__m128i *)p, v);
+#endif
+}
+
+static inline simd_i32 simd_set1(int32_t x) {
+#if defined(SIMD_NEON)
+  return vdupq_n_s32(x);
+#elif defined(SIMD_AVX2)
+  return _mm256_set1_epi32(x);
+#else
+  return _mm_set1_epi32(x);
+#endif
+}
+
+// Lane k holds base + k * step (wrapping like the scalar accumulators)
+static inline simd_i32 simd_ramp(int32_t base, int32_t step) {
+  int32_t lanes[SIMD_LANES];
+  uint32_t x = (uint32_t)base;
+  for (int k = 0; k < SIMD_LANES; k++) {
+    lanes[k] = (int32_t)x;
+    x += (uint32_t)step;
+  }
+  return simd_load(lanes);
+}
+
+static inline simd_i32 simd_add(simd_i32 a, simd_i32 b) {
+#if defined(SIMD_NEON)
+  return vaddq_s32(a, b);
+#elif defined(SIMD_AVX2)
+  return _mm256_add_epi32(a, b);
+#else
+  return _mm_add_epi32(a, b);
+#endif
+}
+
+static inline simd_i32 simd_and(simd_i32 a, simd_i32 b) {
+#if defined(SIMD_NEON)
+  return vandq_s32(a, b);
+#elif defined(SIMD_AVX2)
+  return _mm256_and_si256(a, b);
+#else
+  return _mm_and_si128(a, b);
+#endif
+}
+
+static inline simd_i32 simd_sub(simd_i32 a, simd_i32 b) {
+#if defined(SIMD_NEON)
+  return vsubq_s32(a, b);
+#elif defined(SIMD_AVX2)
+  return _mm256_sub_epi32(a, b);
+#else
+  return _mm_sub_epi32(a, b);
+#endif
+}
+
+static inline simd_i32 simd_xor(simd_i32 a, simd_i32 b) {
+#if defined(SIMD_NEON)
+  return veorq_s32(a, b);
+#elif defined(SIMD_AVX2)
+  return _mm256_xor_si256(a, b);
+#else
+  return _mm_xor_si128(a, b);
+#endif
+}
+
+// Low 32 bits of a * b
+static inline simd_i32 simd_mullo(simd_i32 a, simd_i32 b) {
+#if defined(SIMD_NEON)
+  return vmulq_s32(a, b);
+#elif defined(SIMD_AVX2)
+  return _mm256_mullo_epi32(a, b);
+#else
+  return _mm_mullo_epi32(a, b);
+#endif
+}
+
+// Shift left by a constant
+template<int S>
+static inline simd_i32 simd_slli(simd_i32 a) {
+#if defined(SIMD_NEON)
+  return vshlq_n_s32(a, S);
+#elif defined(SIMD_AVX2)
+  return _mm256_slli_epi32(a, S);
+#else
+  return _mm_slli_epi32(a, S);
+#endif
+}
+
+// Arithmetic shift right by a constant
+template<int S>
+static inline simd_i32 simd_srai(simd_i32 a) {
+#if defined(SIMD_NEON)
+  return vshrq_n_s32(a, S);
+#elif defined(SIMD_AVX2)
+  return _mm256_srai_epi32(a, S);
+#else
+  return _mm_srai_epi32(a, S);
+#endif
+}
+
+// Arithmetic shift right, same runtime count in every lane
+static inline simd_i32 simd_sra(simd_i32 a, int n) {
+#if defined(SIMD_NEON)
+  return vshlq_s32(a, vdupq_n_s32(-n));
+#elif defined(SIMD_AVX2)
+  return _mm256_sra_epi32(a, _mm_cvtsi32_si128(n));
+#else
+  return _mm_sra_epi32(a, _mm_cvtsi32_si128(n));
+#endif
+}
+
+// ((int64_t)a * b) >> S, truncated to 32 bits, for 0 < S <= 32. Only the
+// low half of the shifted product survives, so a logical 64-bit shift
+// gives the same bits as the arithmetic one.
+template<int S>
+static inline simd_i32 simd_mul_shr(simd_i32 a, simd_i32 b) {
+#if defined(SIMD_NEON)
+  int64x2_t lo = vmull_s32(vget_low_s32(a), vget_low_s32(b));
+  int64x2_t hi = vmull_s32(vget_high_s32(a), vget_high_s32(b));
+  return vcombine_s32(vshrn_n_s64(lo, S), vshrn_n_s64(hi, S));
+#elif defined(SIMD_AVX2)
+  __m256i even = _mm256_srli_epi64(_mm256_mul_epi32(a, b), S);
+  __m256i odd = _mm256_srli_epi64(_mm256_mul_epi32(_mm256_srli_epi64(a, 32),
+                                                   _mm256_srli_epi64(b, 32)), S);
+  return _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xaa);
+#else
+  __m128i even = _mm_srli_epi64(_mm_mul_epi32(a, b), S);
+  __m128i odd = _mm_srli_epi64(_mm_mul_epi32(_mm_srli_epi64(a, 32),
+                                             _mm_srli_epi64(b, 32)), S);
+  return _mm_blend_epi16(even, _mm_slli_epi64(odd, 32), 0xcc);
+#endif
+}
+
+// Float lanes, only as much as the polynomial sine and the float kernels
+// need. Plain multiply and add (no fused multiply-add) so every backend
+// rounds the same way.
+static inline simd_f32 simd_fset1(float x) {
+#if defined(SIMD_NEON)
+  return vdupq_n_f32(x);
+#elif defined(SIMD_AVX2)
+  return _mm256_set1_ps(x);
+#else
+  return _mm_set1_ps(x);
+#endif
+}
+
+static inline simd_f32 simd_fload(const float *p) {
+#if defined(SIMD_NEON)
+  return vld1q_f32(p);
+#elif defined(SIMD_AVX2)
+  return _mm256_loadu_ps(p);
+#else
+  return _mm_loadu_ps(p);
+#endif
+}
+
+static inline void simd_fstore(float *p, simd_f32 v) {
+#if defined(SIMD_NEON)
+  vst1q_f32(p, v);
+#elif defined(SIMD_AVX2)
+  _mm256_storeu_ps(p, v);
+#else
+  _mm_storeu_ps(p, v);
+#endif
+}
+
+// Flip the bits of a set in mask m, e.g. the sign with m = 1 << 31
+static inline simd_f32 simd_fflip(simd_f32 a, simd_i32 m) {
+#if defined(SIMD_NEON)
+  return vreinterpretq_f32_s32(veorq_s32(vreinterpretq_s32_f32(a), m));
+#elif defined(SIMD_AVX2)
+  return _mm256_xor_ps(a, _mm256_castsi256_ps(m));
+#else
+  return _mm_xor_ps(a, _mm_castsi128_ps(m));
+#endif
+}
+
+static inline simd_f32 simd_fadd(simd_f32 a, simd_f32 b) {
+#if defined(SIMD_NEON)
+  return vaddq_f32(a, b);
+#elif defined(SIMD_AVX2)
+  return _mm256_add_ps(a, b);
+#else
+  return _mm_add_ps(a, b);
+#endif
+}
+
+static inline simd_f32 simd_fmul(simd_f32 a, simd_f32 b) {
+#if defined(SIMD_NEON)
+  return vmulq_f32(a, b);
+#elif defined(SIMD_AVX2)
+  return _mm256_mul_ps(a, b);
+#else
+  return _mm_mul_ps(a, b);
+#endif
+}
+
+static inline simd_f32 simd_to_float(simd_i32 a) {
+#if defined(SIMD_NEON)
+  return vcvtq_f32_s32(a);
+#elif defined(SIMD_AVX2)
+  return _mm256_cvtepi32_ps(a);
+#else
+  return _mm_cvtepi32_ps(a);
+#endif
+}
+
+// Round to nearest, ties to even
+static inline simd_i32 simd_to_int(simd_f32 a) {
+#if defined(SIMD_NEON)
+  return vcvtnq_s32_f32(a);
+#elif defined(SIMD_AVX2)
+  return _mm256_cvtps_epi32(a);
+#else
+  return _mm_cvtps_epi32(a);
+#endif
+}
+
+// Adjacent pairs: *first = base[idx[k]], *second = base[idx[k] + 1] per lane.
+// Suits interleaved tables such as the SIN_DELTA sine table.
+static inline void simd_gather_pairs(const int32_t *base, simd_i32 idx,
+                                     simd_i32 *first, simd_i32 *second) {
+#if defined(SIMD_NEON)
+  int32x4_t lo = vcombine_s32(vld1_s32(base + vgetq_lane_s32(idx, 0)),
+                              vld1_s32(base + vgetq_lane_s32(idx, 1)));
+  int32x4_t hi = vcombine_s32(vld1_s32(base + vgetq_lane_s32(idx, 2)),
+                              vld1_s32(base + vgetq_lane_s32(idx, 3)));
+  int32x4x2_t u = vuzpq_s32(lo, hi);
+  *first = u.val[0];
+  *second = u.val[1];
+#elif defined(SIMD_AVX2)
+  *first = _mm256_i32gather_epi32(base, idx, 4);
+  *second = _mm256_i32gather_epi32(base + 1, idx, 4);
+#else
+  __m128i lo = _mm_unpacklo_epi64(
+      _mm_loadl_epi64((const __m128i *)(base + _mm_extract_epi32(idx, 0))),
+      _mm_loadl_epi64((const __m128i *)(base + _mm_extract_epi32(idx, 1))));
+  __m128i hi = _mm_unpacklo_epi64(
+      _mm_loadl_epi64((const __m128i *)(base + _mm_extract_epi32(idx, 2))),
+      _mm_loadl_epi64((const __m128i *)(base + _mm_extract_epi32(idx, 3))));
+  *first = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(lo), _mm_castsi128_ps(hi),
+                                           _MM_SHUFFLE(2, 0, 2, 0)));
+  *second = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(lo), _mm_castsi128_ps(hi),
+                                            _MM_SHUFFLE(3, 1, 3, 1)));
+#endif
+}
+
+// Saturate each lane to int16 and store it twice, as an interleaved
+// stereo pair: out[2k] = out[2k + 1] = lane k
+static inline void simd_store_i16_dup(int16_t *out, simd_i32 v) {
+#if defined(SIMD_NEON)
+  int16x4_t n = vqmovn_s32(v);
+  int16x4x2_t d = { { n, n } };
+  vst2_s16(out, d);
+#elif defined(SIMD_AVX2)
+  // packs and unpack work within each 128-bit half, which keeps lanes 0-3
+  // in the low half and 4-7 in the high one
+  __m256i n = _mm256_packs_epi32(v, v);
+  _mm256_storeu_si256((__m256i *)out, _mm256_unpacklo_epi16(n, n));
+#else
+  __m128i n = _mm_packs_epi32(v, v);
+  _mm_storeu_si128((__m128i *)out, _mm_unpacklo_epi16(n, n));
+#endif
+}
+
+#endif  // SIMD_LANES > 1
+
+#endif  // __SIMD_H
@@ -14,6 +14,8 @@
  * limitations under the License.
  */
 
+#include <math.h>
+
 class Sin {
  public:
   Sin();
@@ -24,8 +26,54 @@ class Sin {
 
   // A more accurate sine, both input and output Q30
   static int32_t compute10(int32_t phase);
+
+  // Float polynomial with the same input/output as lookup, no table.
+  // Mirrors sin_poly_simd in fm_op_kernel.cc operation for operation.
+  static int32_t poly(int32_t phase);
+
+  // The same polynomial as a float in [-1, 1], for the float kernels
+  static float polyf(int32_t phase);
 };
 
+// Even polynomial in u = t^2 for cos(pi/2 * t), t in [-1, 1]: the
+// Chebyshev coefficients of Sin::compute (C8_*) rescaled to float.
+// Max error about 1.5 Q24 units before float rounding.
+#define SIN_POLY_0 1.0f
+#define SIN_POLY_2 -1.2336997017f
+#define SIN_POLY_4 0.2536581652f
+#define SIN_POLY_6 -0.0208224907f
+#define SIN_POLY_8 0.0008641187f
+
+inline
+int32_t Sin::poly(int32_t phase) {
+  // Offset from the peak of the current half cycle, t = x / 2^22
+  int32_t x = (phase & ((1 << 23) - 1)) - (1 << 22);
+  float t = (float)x * (1.0f / (1 << 22));
+  float u = t * t;
+  float y = SIN_POLY_8;
+  y = y * u + SIN_POLY_6;
+  y = y * u + SIN_POLY_4;
+  y = y * u + SIN_POLY_2;
+  y = y * u + SIN_POLY_0;
+  int32_t r = (int32_t)lrintf(y * (float)(1 << 24));
+  // Second half cycle is negative
+  int32_t s = -((phase >> 23) & 1);
+  return (r ^ s) - s;
+}
+
+inline
+float Sin::polyf(int32_t phase) {
+  int32_t x = (phase & ((1 << 23) - 1)) - (1 << 22);
+  float t = (float)x * (1.0f / (1 << 22));
+  float u = t * t;
+  float y = SIN_POLY_8;
+  y = y * u + SIN_POLY_6;
+  y = y * u + SIN_POLY_4;
+  y = y * u + SIN_POLY_2;
+  y = y * u + SIN_POLY_0;
+  return (phase & (1 << 23)) ? -y : y;
+}
+
 #define SIN_LG_N_SAMPLES 10
 #define SIN_N_SAMPLES (1 << SIN_LG_N_SAMPLES)
 
@@ -26,7 +26,17 @@ typedef unsigned __int32 uint32_t;
 typedef __int16 SInt16;
 #endif
 
-const static int LG_N = 6;
+// Control block: envelopes, LFO, pitch and operator gains update once
+// every N samples. Build with -DDEXED_LG_N=4..7 (N = 16..128) to trade
+// control rate against per-block cost. Host blocks of any size work; the
+// plugin carries partial control blocks across render calls.
+#ifndef DEXED_LG_N
+#define DEXED_LG_N 6
+#endif
+#if DEXED_LG_N < 4 || DEXED_LG_N > 7
+#error "DEXED_LG_N must be between 4 and 7"
+#endif
+const static int LG_N = DEXED_LG_N;
 const static int N = (1 << LG_N);
 
 #if defined(__APPLE__)
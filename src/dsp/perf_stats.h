@@ -0,0 +1,109 @@
+/*
+ * Render-path timing helpers for the Dexed plugin
+ *
+ * Header-only so the plugin build does not need another translation unit.
+ * Timing uses CLOCK_MONOTONIC, which is served from the vDSO on the Move
+ * and costs a few tens of ns per read.
+ */
+
+#ifndef DEXED_PERF_STATS_H
+#define DEXED_PERF_STATS_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/* Min/avg/max accumulator for one stage of the render path */
+typedef struct {
+    uint64_t count;
+    uint64_t total_ns;
+    uint64_t min_ns;
+    uint64_t max_ns;
+} perf_stage_t;
+
+static inline uint64_t perf_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static inline void perf_stage_reset(perf_stage_t *s) {
+    s->count = 0;
+    s->total_ns = 0;
+    s->min_ns = UINT64_MAX;
+    s->max_ns = 0;
+}
+
+static inline void perf_stage_add(perf_stage_t *s, uint64_t ns) {
+    s->count++;
+    s->total_ns += ns;
+    if (ns < s->min_ns) s->min_ns = ns;
+    if (ns > s->max_ns) s->max_ns = ns;
+}
+
+/* Write {"n":..,"min":..,"avg":..,"max":..} in ns, returns snprintf length */
+static inline int perf_stage_json(const perf_stage_t *s, char *buf, int buf_len) {
+    if (s->count == 0) {
+        return snprintf(buf, buf_len, "{\"n\":0,\"min\":0,\"avg\":0,\"max\":0}");
+    }
+    return snprintf(buf, buf_len, "{\"n\":%llu,\"min\":%llu,\"avg\":%llu,\"max\":%llu}",
+                    (unsigned long long)s->count,
+                    (unsigned long long)s->min_ns,
+                    (unsigned long long)(s->total_ns / s->count),
+                    (unsigned long long)s->max_ns);
+}
+
+/* Histogram of whole-block render time, in fractions of the block's
+ * real-time budget. Buckets are 0.5% wide; the last one also collects
+ * everything slower (the exact maximum is kept separately). */
+#define PERF_HIST_BUCKETS 256
+#define PERF_HIST_PER_BUDGET 200    /* buckets per 100% of budget */
+
+typedef struct {
+    uint32_t buckets[PERF_HIST_BUCKETS];
+    uint64_t count;
+    uint64_t over;                  /* blocks above the threshold */
+    uint64_t max_ns;
+    uint32_t max_permille;          /* slowest block, 0.1% of its budget */
+    uint64_t budget_total_ns;       /* sum of the recorded blocks' budgets */
+} perf_hist_t;
+
+static inline void perf_hist_reset(perf_hist_t *h) {
+    memset(h, 0, sizeof(*h));
+}
+
+/* Record one block that took ns against a budget of budget_ns;
+ * blocks above threshold_pct percent of the budget count as over */
+static inline void perf_hist_add(perf_hist_t *h, uint64_t ns, uint64_t budget_ns, int threshold_pct) {
+    if (budget_ns == 0) return;
+    uint64_t idx = ns * PERF_HIST_PER_BUDGET / budget_ns;
+    if (idx >= PERF_HIST_BUCKETS) idx = PERF_HIST_BUCKETS - 1;
+    h->buckets[idx]++;
+    h->count++;
+    h->budget_total_ns += budget_ns;
+    if (ns * 100 > budget_ns * (uint64_t)threshold_pct) h->over++;
+    if (ns > h->max_ns) h->max_ns = ns;
+    uint64_t permille = ns * 1000 / budget_ns;
+    if (permille > h->max_permille) h->max_permille = (uint32_t)permille;
+}
+
+/* Upper edge of the bucket holding the given percentile, in 0.1% of budget */
+static inline uint32_t perf_hist_percentile(const perf_hist_t *h, int pct) {
+    if (h->count == 0) return 0;
+    uint64_t target = (h->count * pct + 99) / 100;
+    uint64_t seen = 0;
+    for (int i = 0; i < PERF_HIST_BUCKETS; i++) {
+        seen += h->buckets[i];
+        if (seen >= target) return (uint32_t)((i + 1) * 1000 / PERF_HIST_PER_BUDGET);
+    }
+    return h->max_permille;
+}
+
+/* Mean budget of the recorded blocks, for turning percentiles back into ns;
+ * exact when every block had the same size */
+static inline double perf_hist_budget_ns(const perf_hist_t *h) {
+    return h->count ? (double)h->budget_total_ns / h->count : 0.0;
+}
+
+#endif  /* DEXED_PERF_STATS_H */
@@ -0,0 +1,98 @@
+/*
+ * Event trace ring for the Dexed plugin
+ *
+ * Fixed-size, lock-free ring of timestamped events (note on/off, steals,
+ * patch and bank changes, block start/end) for lining up an audible
+ * dropout with whatever happened around it. Any thread may record; a
+ * writer claims a slot with one atomic increment and publishes it with a
+ * sequence number, so the audio path never blocks and the oldest events
+ * are simply overwritten. trace_ring_dump() is meant for a non-audio
+ * context (set_param) and skips slots that are mid-write.
+ */
+
+#ifndef DEXED_TRACE_RING_H
+#define DEXED_TRACE_RING_H
+
+#include <atomic>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "perf_stats.h"
+
+#define TRACE_RING_SIZE 4096    /* Power of two; ~5 s of blocks at 128 frames */
+
+typedef enum {
+    TRACE_BLOCK_START = 0,  /* a = frames */
+    TRACE_BLOCK_END,        /* a = active voices, b = block ns */
+    TRACE_NOTE_ON,          /* a = note, b = voice */
+    TRACE_NOTE_OFF,         /* a = note, b = 1 if held by the sustain pedal */
+    TRACE_VOICE_STEAL,      /* a = voice, b = note it was playing */
+    TRACE_SUSTAIN_RELEASE,  /* a = voices released */
+    TRACE_ALL_NOTES_OFF,
+    TRACE_PATCH_PARAMS,     /* a = voices updated, b = ns */
+    TRACE_PRESET,           /* a = preset index */
+    TRACE_BANK_LOAD,        /* a = bank index (-1 for syx_path), b = ns */
+    TRACE_VOICE_RETIRE,     /* a = voice, b = note (release tail under retire_floor) */
+    TRACE_EVENT_COUNT
+} trace_event_t;
+
+static const char *trace_event_names[TRACE_EVENT_COUNT] = {
+    "block_start", "block_end", "note_on", "note_off", "voice_steal",
+    "sustain_release", "all_notes_off", "patch_params", "preset", "bank_load",
+    "voice_retire"
+};
+
+typedef struct {
+    std::atomic<uint32_t> seq;  /* Claimed index + 1 once written, 0 while writing */
+    uint32_t type;
+    int32_t a;
+    int32_t b;
+    uint64_t t_ns;
+} trace_slot_t;
+
+typedef struct {
+    std::atomic<bool> enabled;
+    std::atomic<uint32_t> next;
+    trace_slot_t slots[TRACE_RING_SIZE];
+} trace_ring_t;
+
+static inline void trace_ring_record(trace_ring_t *r, trace_event_t type, int32_t a, int32_t b) {
+    if (!r->enabled.load(std::memory_order_relaxed)) return;
+    uint32_t idx = r->next.fetch_add(1, std::memory_order_relaxed);
+    trace_slot_t *s = &r->slots[idx & (TRACE_RING_SIZE - 1)];
+    s->seq.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    s->type = type;
+    s->a = a;
+    s->b = b;
+    s->t_ns = perf_now_ns();
+    s->seq.store(idx + 1, std::memory_order_release);
+}
+
+/* Write the ring oldest first as "t_ns event a b" lines; returns events written or -1 */
+static inline int trace_ring_dump(trace_ring_t *r, const char *path) {
+    FILE *f = fopen(path, "w");
+    if (!f) return -1;
+
+    uint32_t end = r->next.load(std::memory_order_acquire);
+    uint32_t start = end > TRACE_RING_SIZE ? end - TRACE_RING_SIZE : 0;
+    int written = 0;
+    fprintf(f, "# t_ns event a b\n");
+    for (uint32_t i = start; i != end; i++) {
+        trace_slot_t *s = &r->slots[i & (TRACE_RING_SIZE - 1)];
+        if (s->seq.load(std::memory_order_acquire) != i + 1) continue;
+        uint32_t type = s->type;
+        int32_t a = s->a;
+        int32_t b = s->b;
+        uint64_t t = s->t_ns;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        /* Overwritten while we copied it */
+        if (s->seq.load(std::memory_order_relaxed) != i + 1 || type >= TRACE_EVENT_COUNT) continue;
+        fprintf(f, "%llu %s %d %d\n", (unsigned long long)t, trace_event_names[type], a, b);
+        written++;
+    }
+    fclose(f);
+    return written;
+}
+
+#endif  /* DEXED_TRACE_RING_H */